@@ -351,6 +351,7 @@ minionsrclist = ['minion/BuildVariables.cpp',
 'minion/minion.cpp',
 'minion/globals.cpp',
 'minion/preprocess.cpp',
+'minion/presolve.cpp',
 'minion/system/trigger_timer.cpp',
 'minion/system/sha1.cpp',
 'minion/help/help.cpp',
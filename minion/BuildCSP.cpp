@@ -68,8 +68,11 @@ void SetupCSPOrdering(CSPInstance& instance, SearchMethod args) {
 void BuildCSP(CSPInstance& instance) {
   getState().setTupleListContainer(instance.tupleListContainer);
   getState().setShortTupleListContainer(instance.shortTupleListContainer);
+  getState().setSmartTupleListContainer(instance.smartTupleListContainer);
 
   // Set up variables
+  if(!getOptions().keepVarTypes)
+    BuildCon::chooseVariableRepresentations(instance);
   BuildCon::buildVariables(instance.vars);
   getState().setInstance(&instance);
 
@@ -82,6 +82,113 @@ AnyVarRef getAnyVarRefFromString(const CSPInstance& c, const std::string& s) {
 }
 
 
+namespace {
+// Constraints which only read and move the bounds of their variables, and
+// never place DomainRemoval triggers. On a variable whose domain never
+// loses a value from its middle, they act the same whether it is stored
+// as DISCRETE or as BOUND.
+bool usesOnlyBounds(ConstraintType type) {
+  switch(type) {
+  case CT_LEQSUM:
+  case CT_GEQSUM:
+  case CT_WEIGHTLEQSUM:
+  case CT_WEIGHTGEQSUM:
+  case CT_INEQ:
+  case CT_WATCHED_LESS:
+  case CT_LEXLEQ:
+  case CT_LEXLESS:
+  case CT_MIN:
+  case CT_MAX:
+  case CT_EQ:
+  case CT_MINUSEQ:
+  case CT_WATCHED_LIT:
+  case CT_WATCHED_INRANGE: return true;
+  default: return false;
+  }
+}
+
+void addAllVars(const ConstraintBlob& b, set<Var>& vars) {
+  for(const auto& list : b.vars)
+    vars.insert(list.begin(), list.end());
+  for(const auto& inner : b.internal_constraints)
+    addAllVars(inner, vars);
+}
+
+void remapVars(ConstraintBlob& b, const vector<Var>& image) {
+  for(auto& list : b.vars)
+    for(auto& v : list)
+      if(v.type() == VAR_DISCRETE)
+        v = image[v.pos()];
+  for(auto& inner : b.internal_constraints)
+    remapVars(inner, image);
+}
+
+void remapVars(vector<Var>& list, const vector<Var>& image) {
+  for(auto& v : list)
+    if(v.type() == VAR_DISCRETE)
+      v = image[v.pos()];
+}
+} // namespace
+
+/// Stores as BOUND each DISCRETE variable which only occurs in constraints
+/// that use its bounds, and which search never branches on with a random
+/// value, so nothing can remove a value from the middle of its domain. Its
+/// propagation is unchanged, but it needs no per-value domain storage or
+/// per-value trigger lists.
+void chooseVariableRepresentations(CSPInstance& instance) {
+  VarContainer& vars = instance.vars;
+
+  set<Var> needValues;
+  for(const auto& c : instance.constraints)
+    if(!usesOnlyBounds(c.constraint->type) || !c.internal_constraints.empty())
+      addAllVars(c, needValues);
+  for(const auto& order : instance.searchOrder)
+    for(SysInt i = 0; i < (SysInt)order.valOrder.size() && i < (SysInt)order.varOrder.size(); ++i)
+      if(order.valOrder[i].type == VALORDER_RANDOM)
+        needValues.insert(order.varOrder[i]);
+
+  vector<Var> image(vars.discrete.size());
+  vector<Bounds> discrete;
+  SysInt moved = 0;
+  for(SysInt i = 0; i < (SysInt)vars.discrete.size(); ++i) {
+    if(needValues.count(Var(VAR_DISCRETE, i))) {
+      image[i] = Var(VAR_DISCRETE, (SysInt)discrete.size());
+      discrete.push_back(vars.discrete[i]);
+    } else {
+      image[i] = Var(VAR_BOUND, (SysInt)vars.bound.size());
+      vars.bound.push_back(vars.discrete[i]);
+      moved++;
+    }
+  }
+
+  getTableOut().set("DiscreteStoredAsBound", tostring(moved));
+  if(moved == 0)
+    return;
+  vars.discrete = discrete;
+
+  for(auto& c : instance.constraints)
+    remapVars(c, image);
+  for(auto& order : instance.searchOrder)
+    remapVars(order.varOrder, image);
+  remapVars(instance.permutation, image);
+  remapVars(instance.symOrder, image);
+  remapVars(instance.preprocess_vars, image);
+  remapVars(instance.constructionSite, image);
+  remapVars(instance.optimiseVariables, image);
+  for(auto& row : instance.print_matrix)
+    remapVars(row, image);
+  for(auto& row : instance.allVars_list)
+    remapVars(row, image);
+
+  for(auto& p : vars.symbol_table)
+    if(p.second.type() == VAR_DISCRETE)
+      p.second = image[p.second.pos()];
+  INPUT_MAP_TYPE<Var, string> names;
+  for(const auto& p : vars.name_table)
+    names[p.first.type() == VAR_DISCRETE ? image[p.first.pos()] : p.first] = p.second;
+  vars.name_table = names;
+}
+
 /// Create all the variables used in the CSP.
 void buildVariables(const ProbSpec::VarContainer& vars) {
   for(int i = 0; i < vars.BOOLs; ++i)
@@ -39,6 +39,10 @@ vector<AnyVarRef> getAnyVarRefFromVar(const vector<Var>& v);
 
 vector<vector<AnyVarRef>> getAnyVarRefFromVar(const vector<vector<Var>>& v);
 
+/// Moves DISCRETE variables whose values are only ever removed from the
+/// ends of their domains into the BOUND container (see -keepvartypes).
+void chooseVariableRepresentations(ProbSpec::CSPInstance& instance);
+
 /// Create all the variables used in the CSP.
 void buildVariables(const ProbSpec::VarContainer& vars);
 } // namespace BuildCon
@@ -93,6 +93,7 @@ struct MinionInstancePrinter {
       case read_constant_list: print_instance(blob.constants[const_pos++]); break;
       case read_tuples: oss << blob.tuples->getName(); break;
       case read_short_tuples: oss << blob.shortTuples->getName(); break;
+      case read_smart_tuples: oss << blob.smartTuples->getName(); break;
       case read_constraint:
         print_instance(blob.internal_constraints[constraint_child_pos]);
         constraint_child_pos++;
@@ -184,10 +185,26 @@ struct MinionInstancePrinter {
     }
   }
 
+  void print_smartTuples() {
+    typedef map<string, SmartTupleList*>::const_iterator it_type;
+
+    for(it_type it = csp.smarttable_symboltable.begin(); it != csp.smarttable_symboltable.end();
+        ++it) {
+      oss << it->first << " " << it->second->size() << "\n";
+      for(SysInt i = 0; i < it->second->size(); ++i) {
+        it->second->printTuple(oss, i);
+        oss << "\n";
+      }
+      oss << endl;
+    }
+  }
+
   void print_tuples() {
     typedef map<string, TupleList*>::const_iterator it_type;
 
     for(it_type it = csp.table_symboltable.begin(); it != csp.table_symboltable.end(); ++it) {
+      if(it->second->isMDDOnly())
+        continue;
       oss << it->first << " ";
       DomainInt tupleSize = it->second->tupleSize();
       DomainInt num_tuples = it->second->size();
@@ -202,6 +219,48 @@ struct MinionInstancePrinter {
     }
   }
 
+  void print_mdds() {
+    typedef map<string, TupleList*>::const_iterator it_type;
+
+    for(it_type it = csp.table_symboltable.begin(); it != csp.table_symboltable.end(); ++it) {
+      if(!it->second->isMDDOnly())
+        continue;
+      MDD* mdd = it->second->getMDD();
+
+      // Number the nodes so the top node is 0. The tt node is printed as 't'.
+      map<MDDNode*, SysInt> index;
+      vector<MDDNode*> order(1, mdd->top);
+      index[mdd->top] = 0;
+      for(SysInt i = 0; i < (SysInt)order.size(); ++i) {
+        for(SysInt j = 0; j < (SysInt)order[i]->links.size(); ++j) {
+          MDDNode* child = order[i]->links[j].second;
+          if(child->type != -1 && index.count(child) == 0) {
+            index[child] = order.size();
+            order.push_back(child);
+          }
+        }
+      }
+
+      oss << it->first << " " << mdd->arity << " " << order.size() << "\n";
+      for(SysInt i = 0; i < (SysInt)order.size(); ++i) {
+        oss << "[";
+        for(SysInt j = 0; j < (SysInt)order[i]->links.size(); ++j) {
+          if(j > 0)
+            oss << ", ";
+          MDDNode* child = order[i]->links[j].second;
+          oss << "(" << order[i]->links[j].first << ",";
+          if(child->type == -1)
+            oss << "t";
+          else
+            oss << index[child];
+          oss << ")";
+        }
+        oss << "]\n";
+      }
+      oss << endl;
+    }
+  }
+
   void printSearchInfo(const vector<Var>& varVec) {
     set<Var> vars(varVec.begin(), varVec.end());
 
@@ -328,6 +387,21 @@ struct MinionInstancePrinter {
     oss << "**SHORTTUPLELIST**" << endl;
     print_shortTuples();
 
+    // Only print this section when it is needed, so instances with no MDDs
+    // can still be read by older versions of Minion.
+    for(auto it = csp.table_symboltable.begin(); it != csp.table_symboltable.end(); ++it) {
+      if(it->second->isMDDOnly()) {
+        oss << "**MDD**" << endl;
+        print_mdds();
+        break;
+      }
+    }
+
+    if(!csp.smarttable_symboltable.empty()) {
+      oss << "**SMARTTUPLELIST**" << endl;
+      print_smartTuples();
+    }
+
     oss << "**CONSTRAINTS**" << endl;
     for(list<ConstraintBlob>::const_iterator it = constraints.begin(); it != constraints.end();
         ++it) {
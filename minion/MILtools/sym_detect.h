@@ -0,0 +1,375 @@
+/*
+ * Minion http://minion.sourceforge.net
+ * Copyright (C) 2006-09
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+#ifndef SYM_DETECT_H
+#define SYM_DETECT_H
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+/// An ordered partition of the vertices of a graph, which can be split into
+/// finer partitions and then returned to an earlier state.
+///
+/// Cells are identified by the position of their first element. Splitting
+/// a cell keeps the first piece at the old start, so undoing splits in
+/// reverse order restores the earlier cells exactly (as sets).
+struct OrderedPartition {
+  std::vector<SysInt> elements;
+  std::vector<SysInt> position;
+  // Start of the cell containing each vertex.
+  std::vector<SysInt> cellOf;
+  // End of each cell, indexed by start.
+  std::vector<SysInt> cellEnd;
+  std::vector<SysInt> splits;
+  SysInt cellCount;
+
+  OrderedPartition() : cellCount(0) {}
+
+  OrderedPartition(const std::vector<std::vector<SysInt>>& cells, SysInt vertices)
+      : position(vertices), cellOf(vertices), cellEnd(vertices), cellCount(0) {
+    for(const auto& cell : cells) {
+      if(cell.empty())
+        continue;
+      SysInt start = elements.size();
+      for(SysInt v : cell) {
+        position[v] = elements.size();
+        cellOf[v] = start;
+        elements.push_back(v);
+      }
+      cellEnd[start] = elements.size();
+      cellCount++;
+    }
+    D_ASSERT((SysInt)elements.size() == vertices);
+  }
+
+  bool discrete() const {
+    return cellCount == (SysInt)elements.size();
+  }
+
+  SysInt cellSize(SysInt start) const {
+    return cellEnd[start] - start;
+  }
+
+  void swapTo(SysInt v, SysInt pos) {
+    SysInt other = elements[pos];
+    SysInt old = position[v];
+    elements[old] = other;
+    position[other] = old;
+    elements[pos] = v;
+    position[v] = pos;
+  }
+
+  /// Splits the cell starting at start, so a new cell starts at at.
+  void split(SysInt start, SysInt at) {
+    D_ASSERT(start < at && at < cellEnd[start]);
+    cellEnd[at] = cellEnd[start];
+    cellEnd[start] = at;
+    for(SysInt i = at; i < cellEnd[at]; ++i)
+      cellOf[elements[i]] = at;
+    splits.push_back(at);
+    cellCount++;
+  }
+
+  /// Undoes splits until only mark splits remain.
+  void undoTo(SysInt mark) {
+    while((SysInt)splits.size() > mark) {
+      SysInt at = splits.back();
+      splits.pop_back();
+      SysInt start = cellOf[elements[at - 1]];
+      SysInt end = cellEnd[at];
+      for(SysInt i = at; i < end; ++i)
+        cellOf[elements[i]] = start;
+      cellEnd[start] = end;
+      cellCount--;
+    }
+  }
+};
+
+/// Finds generators of the automorphism group of a vertex-coloured
+/// undirected graph, by individualisation and refinement (in the style of
+/// nauty and saucy).
+///
+/// The first path of the search tree is explored to a discrete partition.
+/// Then, working back up this path, at each level we look for automorphisms
+/// which fix the vertices individualised above that level and map the
+/// vertex individualised at that level to each other vertex in its cell,
+/// skipping vertices already known to be in the same orbit. Each such
+/// search is limited to a number of nodes, so some generators may be
+/// missed, but every permutation returned is an automorphism.
+struct AutomorphismFinder {
+  SysInt vertices;
+  std::vector<std::vector<SysInt>> adj;
+  OrderedPartition left;
+  OrderedPartition right;
+
+  // Individualised vertex, target cell and refinement trace at each level
+  // of the first path.
+  std::vector<SysInt> firstPath;
+  std::vector<SysInt> targetCell;
+  std::vector<SysInt> splitMark;
+  std::vector<std::vector<SysInt>> traces;
+  std::vector<SysInt> leaf;
+
+  std::vector<SysInt> orbit;
+  std::vector<std::vector<SysInt>> generators;
+
+  // Search nodes allowed for each vertex we try to map to, and in total.
+  long long nodeLimit;
+  long long nodes;
+  long long totalNodes;
+
+  // Scratch space for refinement.
+  std::vector<SysInt> count;
+  std::vector<char> inQueue;
+  std::vector<SysInt> mark;
+  SysInt stamp;
+
+  AutomorphismFinder(const std::vector<std::set<SysInt>>& edges,
+                     const std::vector<std::set<SysInt>>& colours, long long _nodeLimit = 10000)
+      : vertices(edges.size()),
+        adj(edges.size()),
+        nodeLimit(_nodeLimit),
+        nodes(0),
+        totalNodes(0),
+        count(edges.size()),
+        inQueue(edges.size()),
+        mark(edges.size()),
+        stamp(0) {
+    for(SysInt i = 0; i < vertices; ++i)
+      for(SysInt j : edges[i]) {
+        adj[i].push_back(j);
+        adj[j].push_back(i);
+      }
+    for(auto& a : adj) {
+      std::sort(a.begin(), a.end());
+      a.erase(std::unique(a.begin(), a.end()), a.end());
+    }
+
+    std::vector<std::vector<SysInt>> cells;
+    for(const auto& c : colours)
+      cells.push_back(std::vector<SysInt>(c.begin(), c.end()));
+    left = OrderedPartition(cells, vertices);
+
+    orbit.resize(vertices);
+    for(SysInt i = 0; i < vertices; ++i)
+      orbit[i] = i;
+  }
+
+  SysInt findOrbit(SysInt v) {
+    while(orbit[v] != v) {
+      orbit[v] = orbit[orbit[v]];
+      v = orbit[v];
+    }
+    return v;
+  }
+
+  /// Refines p until it is equitable, starting from the cells in queue.
+  /// Every split is recorded in trace, which depends only on the structure
+  /// of the graph, so two partitions related by an automorphism produce the
+  /// same trace.
+  void refine(OrderedPartition& p, std::vector<SysInt> queue, std::vector<SysInt>& trace) {
+    for(SysInt s : queue)
+      inQueue[s] = 1;
+    std::vector<SysInt> touched;
+    for(SysInt q = 0; q < (SysInt)queue.size(); ++q) {
+      SysInt s = queue[q];
+      inQueue[s] = 0;
+      for(SysInt i = s; i < p.cellEnd[s]; ++i)
+        for(SysInt y : adj[p.elements[i]])
+          if(count[y]++ == 0)
+            touched.push_back(y);
+
+      // Only the touched vertices are moved, so a large cell with few
+      // neighbours in the splitter is cheap to split.
+      std::sort(touched.begin(), touched.end(), [&](SysInt a, SysInt b) {
+        return p.cellOf[a] < p.cellOf[b] ||
+               (p.cellOf[a] == p.cellOf[b] && count[a] < count[b]);
+      });
+      for(SysInt t = 0; t < (SysInt)touched.size();) {
+        SysInt c = p.cellOf[touched[t]];
+        SysInt group = t;
+        while(t < (SysInt)touched.size() && p.cellOf[touched[t]] == c)
+          t++;
+        SysInt end = p.cellEnd[c];
+        SysInt tail = end - (t - group);
+        if(tail == c && count[touched[group]] == count[touched[t - 1]])
+          continue;
+        for(SysInt i = group; i < t; ++i)
+          p.swapTo(touched[i], tail + i - group);
+
+        std::vector<SysInt> pieces(1, c);
+        if(tail != c)
+          pieces.push_back(tail);
+        for(SysInt i = tail + 1; i < end; ++i)
+          if(count[p.elements[i]] != count[p.elements[i - 1]])
+            pieces.push_back(i);
+        pieces.push_back(end);
+        trace.push_back(c);
+        trace.push_back(pieces.size() - 1);
+        // If the cell was not waiting to be used as a splitter, its largest
+        // piece does not need to be, as the others say everything it would.
+        SysInt largest = inQueue[c] ? -1 : c;
+        SysInt largestSize = 0;
+        for(SysInt i = 0; i + 1 < (SysInt)pieces.size(); ++i) {
+          SysInt size = pieces[i + 1] - pieces[i];
+          trace.push_back(count[p.elements[pieces[i]]]);
+          trace.push_back(size);
+          if(largest != -1 && size > largestSize) {
+            largest = pieces[i];
+            largestSize = size;
+          }
+        }
+        for(SysInt i = (SysInt)pieces.size() - 2; i >= 1; --i)
+          p.split(c, pieces[i]);
+        for(SysInt i = 0; i + 1 < (SysInt)pieces.size(); ++i) {
+          SysInt piece = pieces[i];
+          if(piece != largest && !inQueue[piece]) {
+            inQueue[piece] = 1;
+            queue.push_back(piece);
+          }
+        }
+      }
+      for(SysInt y : touched)
+        count[y] = 0;
+      touched.clear();
+    }
+  }
+
+  /// Makes v a cell of its own, then refines.
+  void individualise(OrderedPartition& p, SysInt v, std::vector<SysInt>& trace) {
+    SysInt start = p.cellOf[v];
+    D_ASSERT(p.cellSize(start) > 1);
+    p.swapTo(v, start);
+    p.split(start, start + 1);
+    refine(p, std::vector<SysInt>(1, start), trace);
+  }
+
+  SysInt firstNonSingleton(const OrderedPartition& p, SysInt from) {
+    SysInt i = from;
+    while(p.cellSize(i) == 1)
+      i = p.cellEnd[i];
+    return i;
+  }
+
+  bool isAutomorphism(const std::vector<SysInt>& perm) {
+    for(SysInt x = 0; x < vertices; ++x) {
+      stamp++;
+      for(SysInt y : adj[perm[x]])
+        mark[y] = stamp;
+      for(SysInt y : adj[x])
+        if(mark[perm[y]] != stamp)
+          return false;
+    }
+    return true;
+  }
+
+  /// Searches below the right partition at the given level for a leaf which
+  /// matches the first path leaf with an automorphism.
+  bool searchRight(SysInt level) {
+    if(++nodes > nodeLimit)
+      return false;
+    if(level == (SysInt)firstPath.size()) {
+      D_ASSERT(right.discrete());
+      std::vector<SysInt> perm(vertices);
+      for(SysInt i = 0; i < vertices; ++i)
+        perm[leaf[i]] = right.elements[i];
+      if(!isAutomorphism(perm))
+        return false;
+      generators.push_back(perm);
+      for(SysInt i = 0; i < vertices; ++i)
+        orbit[findOrbit(i)] = findOrbit(perm[i]);
+      return true;
+    }
+
+    SysInt start = targetCell[level];
+    SysInt splitsBefore = right.splits.size();
+    std::vector<SysInt> cell(right.elements.begin() + start,
+                             right.elements.begin() + right.cellEnd[start]);
+    for(SysInt u : cell) {
+      std::vector<SysInt> trace;
+      individualise(right, u, trace);
+      bool found = trace == traces[level] && searchRight(level + 1);
+      right.undoTo(splitsBefore);
+      if(found)
+        return true;
+      if(nodes > nodeLimit)
+        return false;
+    }
+    return false;
+  }
+
+  /// Returns a set of generators of the automorphism group. Each generator
+  /// maps vertex i to gen[i].
+  std::vector<std::vector<SysInt>> findGenerators() {
+    std::vector<SysInt> all;
+    for(SysInt i = 0; i < vertices; i = left.cellEnd[i])
+      all.push_back(i);
+    std::vector<SysInt> trace;
+    refine(left, all, trace);
+
+    SysInt start = 0;
+    while(!left.discrete()) {
+      start = firstNonSingleton(left, start);
+      SysInt v = left.elements[start];
+      firstPath.push_back(v);
+      targetCell.push_back(start);
+      splitMark.push_back(left.splits.size());
+      traces.push_back(std::vector<SysInt>());
+      individualise(left, v, traces.back());
+    }
+    leaf = left.elements;
+
+    for(SysInt level = (SysInt)firstPath.size() - 1; level >= 0; --level) {
+      left.undoTo(splitMark[level]);
+      SysInt v = firstPath[level];
+      SysInt start = targetCell[level];
+      std::vector<SysInt> cell(left.elements.begin() + start,
+                               left.elements.begin() + left.cellEnd[start]);
+      std::vector<SysInt> failed;
+      right = left;
+      for(SysInt w : cell) {
+        if(findOrbit(w) == findOrbit(v))
+          continue;
+        bool skip = false;
+        for(SysInt f : failed)
+          if(findOrbit(f) == findOrbit(w))
+            skip = true;
+        if(skip)
+          continue;
+
+        nodes = 0;
+        SysInt splitsBefore = right.splits.size();
+        std::vector<SysInt> trace;
+        individualise(right, w, trace);
+        bool found = trace == traces[level] && searchRight(level + 1);
+        right.undoTo(splitsBefore);
+        if(!found)
+          failed.push_back(w);
+        totalNodes += nodes;
+        if(totalNodes > nodeLimit * 100)
+          return generators;
+      }
+    }
+    return generators;
+  }
+};
+
+#endif
@@ -342,6 +342,44 @@ struct GraphBuilder {
         add_edge(vij, b.vars[i][j]);
       }
 
+    colour_arguments(b, name, v);
+    return v;
+  }
+
+  // Attaches the constants and tuple lists of a constraint to its vertex v,
+  // with each constant in a fixed position.
+  void colour_arguments(const ConstraintBlob& b, string name, string v) {
+    for(SysInt i = 0; i < (SysInt)b.constants.size(); ++i)
+      for(SysInt j = 0; j < (SysInt)b.constants[i].size(); ++j) {
+        string vij = g.new_vertex(name + "_CONST_" + tostring(i) + ";" + tostring(j));
+        add_edge(v, vij);
+        add_edge(vij, Var(VAR_CONSTANT, b.constants[i][j]));
+      }
+
+    for(SysInt i = 0; i < b.constraint->numberOfParams; ++i) {
+      string table;
+      switch(b.constraint->read_types[i]) {
+      case read_tuples: table = "TUPLES_" + tostring(size_t(b.tuples)); break;
+      case read_short_tuples: table = "SHORTTUPLES_" + tostring(size_t(b.shortTuples)); break;
+      case read_smart_tuples: table = "SMARTTUPLES_" + tostring(size_t(b.smartTuples)); break;
+      default: continue;
+      }
+      add_edge(v, g.new_vertex(name + "_" + table));
+    }
+  }
+
+  // Any other constraint is assumed to have no symmetry, and its child
+  // constraints keep their positions.
+  string colour_unknown(const ConstraintBlob& b) {
+    string name = b.constraint->name;
+    string v = colour_no_symmetry(b, name);
+    for(SysInt i = 0; i < (SysInt)b.internal_constraints.size(); ++i) {
+      string vi = g.new_vertex(name + "_CHILD_CON_" + tostring(i));
+      add_edge(v, vi);
+      add_edge(vi, colour_constraint(b.internal_constraints[i]));
+    }
+    if(b.gadget)
+      add_edge(v, g.new_vertex(name + "_GADGET_" + tostring(size_t(b.gadget.get()))));
     return v;
   }
 
@@ -374,8 +412,10 @@ struct GraphBuilder {
       D_ASSERT(b.vars[i].size() == 1);
       string vi = g.new_vertex(name + "_POS_" + tostring(i));
       add_edge(v, vi);
+      add_edge(vi, b.vars[i][0]);
     }
 
+    colour_arguments(b, name, v);
     return v;
   }
 
@@ -401,8 +441,10 @@ struct GraphBuilder {
       D_ASSERT(b.vars[i].size() == 1);
       string vi = g.new_vertex(name + "_POS_" + tostring(i));
       add_edge(v, vi);
+      add_edge(vi, b.vars[i][0]);
     }
 
+    colour_arguments(b, name, v);
     return v;
   }
 
@@ -429,6 +471,7 @@ struct GraphBuilder {
       D_ASSERT(b.vars[i].size() == 1);
       string vi = g.new_vertex(name + "_POS_" + tostring(i));
       add_edge(v, vi);
+      add_edge(vi, b.vars[i][0]);
     }
     return v;
   }
@@ -472,7 +515,7 @@ struct GraphBuilder {
       add_edge(v, vm);
       add_edge(vm, v1);
       add_edge(vm, v2);
-      add_edge(v1, b.vars[0][i]);
+      add_edge(v1, b.vars[1][i]);
       add_edge(v2, Var(VAR_CONSTANT, b.constants[0][i]));
     }
 
@@ -654,7 +697,7 @@ struct GraphBuilder {
 
     case CT_WATCHED_NEW_AND: return colour_symmetric_parent_constraint(b, "AND");
 
-    default: cerr << "No colouring defined for " << b.constraint->name << endl; abort();
+    default: return colour_unknown(b);
     }
   }
 };
@@ -98,9 +98,12 @@ AbstractConstraint* BuildConObj<constraint, size>::build(const ConData& partial_
   } else
 #endif
   {
-    vector<AnyVarRef> v(vars.size());
-    for(UnsignedSysInt i = 0; i < vars.size(); ++i)
-      v[i] = getAnyVarRefFromVar(vars[i]);
+    vector<TaggedVarRef> v(vars.size());
+    for(UnsignedSysInt i = 0; i < vars.size(); ++i) {
+      if(vars[i].type() == VAR_SPARSEDISCRETE)
+        INPUT_ERROR("Sparse Discrete not supported at present");
+      v[i] = TaggedVarRef(vars[i]);
+    }
 
     return BuildConObj<constraint, size - 1>::build(make_pair(partial_build, &v), b, pos + 1);
   }
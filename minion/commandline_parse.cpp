@@ -141,6 +141,32 @@ void parseCommandLine(SearchMethod& args, SysInt argc, char** argv) {
       args.preprocess = GetPropMethodFromString(prop_mode);
     }
 
+    else if(command == string("-preprocess-cores")) {
+      INCREMENT_i(-preprocess-cores);
+      getOptions().preprocessCores = atoi(argv[i]);
+      if(getOptions().preprocessCores < 1)
+        outputFatalError("-preprocess-cores must be at least 1");
+    }
+
+
+
+    else if(command == string("-symmetry-lex") || command == string("-symmetry-dynamic")) {
+      SymmetryBreak sb = (command == string("-symmetry-lex")) ? SB_Lex : SB_Dynamic;
+      if(getOptions().symmetryBreak != SB_None && getOptions().symmetryBreak != sb)
+        outputFatalError("-symmetry-lex and -symmetry-dynamic cannot be used together");
+      getOptions().symmetryBreak = sb;
+    }
+
+    else if(command == string("-presolve")) {
+      getOptions().presolve = true;
+    }
+
+
+
+    else if(command == string("-keepvartypes")) {
+      getOptions().keepVarTypes = true;
+    }
+
 
 
     else if(command == string("-nocheck")) {
@@ -92,7 +92,11 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
   using FlowConstraint<VarArray, UseIncGraph>::constraintLocked;
   using FlowConstraint<VarArray, UseIncGraph>::adjlist;
   using FlowConstraint<VarArray, UseIncGraph>::adjlistlength;
-  using FlowConstraint<VarArray, UseIncGraph>::adjlistpos;
+  using FlowConstraint<VarArray, UseIncGraph>::adjlist_in;
+  using FlowConstraint<VarArray, UseIncGraph>::edgeIndex;
+  using FlowConstraint<VarArray, UseIncGraph>::edgeVar;
+  using FlowConstraint<VarArray, UseIncGraph>::edgeVal;
+  using FlowConstraint<VarArray, UseIncGraph>::numEdges;
   using FlowConstraint<VarArray, UseIncGraph>::adjlist_remove;
   using FlowConstraint<VarArray, UseIncGraph>::varArray;
   using FlowConstraint<VarArray, UseIncGraph>::domMin;
@@ -109,6 +113,14 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
   using FlowConstraint<VarArray, UseIncGraph>::initialize_hopcroft;
   using FlowConstraint<VarArray, UseIncGraph>::hopcroft_wrapper;
 
+  using FlowConstraint<VarArray, UseIncGraph>::tstack;
+  using FlowConstraint<VarArray, UseIncGraph>::in_tstack;
+  using FlowConstraint<VarArray, UseIncGraph>::visited;
+  using FlowConstraint<VarArray, UseIncGraph>::dfsnum;
+  using FlowConstraint<VarArray, UseIncGraph>::lowlink;
+  using FlowConstraint<VarArray, UseIncGraph>::maxDfs;
+  using FlowConstraint<VarArray, UseIncGraph>::initialize_tarjan_stacks;
+
   virtual string constraintName() {
     return "gacalldiff";
   }
@@ -171,7 +183,7 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
     // are used.
 
     if(UseIncGraph)
-      return numvars * numvals; // one for each var-val pair so we know when it is removed.
+      return numEdges(); // one for each var-val pair so we know when it is removed.
     else
       return 0;
   }
@@ -294,14 +306,13 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
     }
 
 #if UseIncGraph
-    if(trig >= 0 && trig < numvars * numvals) // does this trigger belong to incgraph?
+    if(trig >= 0 && trig < numEdges()) // does this trigger belong to incgraph?
     {
-      SysInt diff = trig;
-      SysInt var = diff / numvals;
-      SysInt validx = diff % numvals;
-      if(adjlistpos[validx + numvars][var] < adjlistlength[validx + numvars]) {
-        P("Removing var, val " << var << "," << (validx + domMin) << " from adjacency list.");
-        adjlist_remove(var, validx + domMin); // validx, adjlistpos[validx][var]);
+      SysInt var = edgeVar[trig];
+      SysInt val = edgeVal(trig);
+      if(adjlist_in(var, val)) {
+        P("Removing var, val " << var << "," << val << " from adjacency list.");
+        adjlist_remove(var, val);
       }
       return;
     }
@@ -592,7 +603,7 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
         }
 
         // cout << "Running tarjan's on component "<< var_indices <<endl;
-        tarjan_recursive(j);
+        tarjan(j);
       }
     }
 
@@ -677,7 +688,7 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
       var_indices.push_back(i);
 
     if(numvars > 0)
-      tarjan_recursive(0);
+      tarjan(0);
 
     return;
   }
@@ -695,10 +706,8 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
             j--; // stay in the same place, dont' skip over the
                  // value which was just swapped into the current position.
           } else {
-            // arranged in blocks for each variable, with numvals triggers in
-            // each block
-            DomainInt mydt = (var * numvals) + (i - domMin);
-            this->moveTriggerInt(varArray[var], mydt, DomainRemoval, i);
+            // one trigger for each edge of the graph
+            this->moveTriggerInt(varArray[var], edgeIndex(var, i), DomainRemoval, i);
           }
         }
       }
@@ -821,22 +830,11 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
   end if
   */
 
-  vector<SysInt> tstack;
-  smallset_nolist in_tstack;
-  smallset_nolist visited;
-  vector<SysInt> dfsnum;
-  vector<SysInt> lowlink;
-
-  // vector<SysInt> iterationstack;
-  vector<SysInt> curnodestack;
-
   // Filled in before calling tarjan's.
   bool sccSplit;
 
   SysInt sccindex;
 
-  SysInt maxDfs;
-
   vector<SysInt> spareValues;
   bool include_sink;
   vector<SysInt> var_indices; // Should be a pointer so it can be changed.
@@ -845,26 +843,24 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
 
   SysInt varcount;
 
+#if UseWatches
+  vector<SysInt> lowlinkvar; // Where the lowlink of each value came from.
+#endif
+
   // An integer represents a vertex, where 0 .. numvars-1 represent the vars,
   // numvars .. numvars+numvals-1 represents the values (val-domMin+numvars),
   // numvars+numvals is the sink,
   // numvars+numvals+1 is the
 
   void initialize_tarjan() {
-    SysInt numnodes = numvars + numvals + 1; // One sink node.
-    tstack.reserve(numnodes);
-    in_tstack.reserve(numnodes);
-    visited.reserve(numnodes);
-    maxDfs = 1;
+    initialize_tarjan_stacks();
     sccSplit = false;
-    dfsnum.resize(numnodes);
-    lowlink.resize(numnodes);
-
-    // iterationstack.resize(numnodes);
-    curnodestack.reserve(numnodes);
+#if UseWatches
+    lowlinkvar.resize(numvars + numvals + 1, -1);
+#endif
   }
 
-  void tarjan_recursive(SysInt sccindexStart) {
+  void tarjan(SysInt sccindexStart) {
     valinlocalmatching.clear();
 
     DomainInt localmax = varArray[var_indices[0]].max();
@@ -926,67 +922,27 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
       if(!visited.in(curnode)) {
         P("(Re)starting tarjan's algorithm, value:" << curnode);
         varcount = 0;
-        visit(curnode, true, sccindexStart);
+        this->tarjan_dfs(this, curnode);
         P("Returned from tarjan's algorithm.");
       }
     }
   }
 
-  void visit(SysInt curnode, bool toplevel, SysInt sccindexStart) {
-    tstack.push_back(curnode);
-    in_tstack.insert(curnode);
-    dfsnum[curnode] = maxDfs;
-    lowlink[curnode] = maxDfs;
-    maxDfs++;
-    visited.insert(curnode);
-    // cout << "Visiting node: " <<curnode<<endl;
-
-    if(curnode == numvars + numvals) {
-      // cout << "Visiting sink node." <<endl;
-      D_ASSERT(include_sink);
-      // It's the sink so it links to all spare values.
+  // The residual graph, walked by tarjan_dfs.
 
-      for(SysInt i = 0; i < (SysInt)spareValues.size(); ++i) {
-        SysInt newnode = spareValues[i];
-        // cout << "About to visit spare value: " << newnode-numvars+domMin
-        // <<endl;
-        if(!visited.in(newnode)) {
-          visit(newnode, false, sccindexStart);
-          if(lowlink[newnode] < lowlink[curnode]) {
-            lowlink[curnode] = lowlink[newnode];
-          }
-        } else {
-          // Already visited newnode
-          if(in_tstack.in(newnode) && dfsnum[newnode] < lowlink[curnode]) {
-            lowlink[curnode] = dfsnum[newnode];
-          }
-        }
-      }
-    } else if(curnode < numvars) // This case should never occur with merge nodes.
-    {
+  void tarjan_enter(SysInt curnode, SysInt parent) {
+    // cout << "Visiting node: " <<curnode<<endl;
+    if(curnode < numvars) {
       D_ASSERT(find(var_indices.begin(), var_indices.end(), curnode) != var_indices.end());
       varcount++;
-      // cout << "Visiting node variable: "<< curnode<<endl;
-      SysInt newnode = varvalmatching[curnode] - domMin + numvars;
-      D_ASSERT(varArray[curnode].inDomain(newnode + domMin - numvars));
-
-      if(!visited.in(newnode)) {
-        visit(newnode, false, sccindexStart);
-        if(lowlink[newnode] < lowlink[curnode]) {
-          lowlink[curnode] = lowlink[newnode];
-        }
-      } else {
-        // Already visited newnode
-        if(in_tstack.in(newnode) && dfsnum[newnode] < lowlink[curnode]) {
-          lowlink[curnode] = dfsnum[newnode]; // Why dfsnum not lowlink?
-        }
+#if UseWatches
+      // set a watch on the edge from the value we came from.
+      if(parent != -1) {
+        P("Adding DT for var " << curnode << " val " << parent - numvars + domMin);
+        watches[curnode].insert(parent - numvars);
       }
-    } else {
-      // curnode is a value
-      // This is the only case where watches are set.
-      // cout << "Visiting node val: "<< curnode+domMin-numvars <<endl;
-
-      D_ASSERT(curnode >= numvars && curnode < (numvars + numvals));
+#endif
+    } else if(curnode < numvars + numvals) {
 #ifndef NO_DEBUG
       bool found = false;
       for(SysInt i = 0; i < (SysInt)var_indices.size(); i++) {
@@ -996,90 +952,74 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
       }
       D_ASSERT(found);
 #endif
-
 #if UseWatches
-      SysInt lowlinkvar = -1;
+      lowlinkvar[curnode] = -1;
 #endif
+    } else {
+      D_ASSERT(include_sink);
+    }
+  }
+
+  SysInt tarjan_next(SysInt curnode, SysInt& pos) {
+    if(curnode == numvars + numvals) {
+      // It's the sink so it links to all spare values.
+      if(pos < (SysInt)spareValues.size())
+        return spareValues[pos++];
+      return -1;
+    }
+
+    if(curnode < numvars) {
+      // A variable links to the value it is matched to.
+      if(pos++ > 0)
+        return -1;
+      D_ASSERT(varArray[curnode].inDomain(varvalmatching[curnode]));
+      return varvalmatching[curnode] - domMin + numvars;
+    }
 
+    // curnode is a value. It links to the variables it is not matched to.
+    SysInt val = curnode + domMin - numvars;
 #if !UseIncGraph
-      for(SysInt i = 0; i < (SysInt)var_indices.size(); i++) {
-        SysInt newnode = var_indices[i];
+    const SysInt listsize = var_indices.size();
 #else
-      for(SysInt i = 0; i < adjlistlength[curnode]; i++) {
-        SysInt newnode = adjlist[curnode][i];
+    const SysInt listsize = adjlistlength[curnode];
 #endif
-        if(varvalmatching[newnode] !=
-           curnode - numvars + domMin) // if the value is not in the matching.
-        {
+    while(pos < listsize) {
 #if !UseIncGraph
-          if(varArray[newnode].inDomain(curnode + domMin - numvars))
-#endif
-          {
-            D_ASSERT(varArray[newnode].inDomain(curnode + domMin - numvars));
-            // newnode=varvalmatching[newnode]-domMin+numvars;  // Changed here
-            // for merge nodes
-            if(!visited.in(newnode)) {
-// set a watch
-#if UseWatches
-              P("Adding DT for var " << newnode << " val " << curnode - numvars + domMin);
-              watches[newnode].insert(curnode - numvars);
+      SysInt newnode = var_indices[pos++];
+      if(varvalmatching[newnode] != val && varArray[newnode].inDomain(val))
+        return newnode;
+#else
+      SysInt newnode = adjlist[curnode][pos++];
+      if(varvalmatching[newnode] != val) {
+        D_ASSERT(varArray[newnode].inDomain(val));
+        return newnode;
+      }
 #endif
+    }
 
-              visit(newnode, false, sccindexStart);
-              if(lowlink[newnode] < lowlink[curnode]) {
-                lowlink[curnode] = lowlink[newnode];
-#if UseWatches
-                lowlinkvar = -1; // Would be placing a watch where there already is one.
-#endif
-              }
-            } else {
-              // Already visited newnode
-              if(in_tstack.in(newnode) && dfsnum[newnode] < lowlink[curnode]) {
-                lowlink[curnode] = dfsnum[newnode];
-#if UseWatches
-                lowlinkvar = newnode;
-#endif
-              }
-            }
-          }
-        }
-      }
+    // Finally, a value in the matching links to the sink.
+    if(pos++ == listsize && include_sink && valinlocalmatching.in(curnode - numvars))
+      return numvars + numvals;
+    return -1;
+  }
 
-      // Why the find? Can we not use some DS which is already lying around?
-      // And why does it include the whole matching in the find??
-      if(include_sink && valinlocalmatching.in(curnode - numvars))
-      //    find(varvalmatching.begin(), varvalmatching.end(),
-      //    curnode+domMin-numvars)!=varvalmatching.end())
-      {
-        SysInt newnode = numvars + numvals;
-        if(!visited.in(newnode)) {
-          visit(newnode, false, sccindexStart);
-          if(lowlink[newnode] < lowlink[curnode]) {
-            lowlink[curnode] = lowlink[newnode];
-#if UseWatches
-            lowlinkvar = -1;
-#endif
-          }
-        } else {
-          // Already visited newnode
-          if(in_tstack.in(newnode) && dfsnum[newnode] < lowlink[curnode]) {
-            lowlink[curnode] = dfsnum[newnode];
+  void tarjan_lowered(SysInt curnode, SysInt from) {
 #if UseWatches
-            lowlinkvar = -1;
+    // Remember a back edge to a variable, so a watch can be placed on it.
+    if(curnode >= numvars && curnode < numvars + numvals)
+      lowlinkvar[curnode] = (from != -1 && from < numvars) ? from : -1;
 #endif
-          }
-        }
-      }
+  }
 
+  void tarjan_finish(SysInt curnode, bool toplevel) {
 // Where did the low link value come from? insert that edge into watches.
 #if UseWatches
-      if(lowlinkvar != -1) {
-        P("Adding DT for var " << lowlinkvar << " val " << curnode - numvars + domMin);
+    if(curnode >= numvars && curnode < numvars + numvals && lowlinkvar[curnode] != -1) {
+      P("Adding DT for var " << lowlinkvar[curnode] << " val " << curnode - numvars + domMin);
 
-        watches[lowlinkvar].insert(curnode - numvars);
-      }
-#endif
+      watches[lowlinkvar[curnode]].insert(curnode - numvars);
     }
+#endif
 
     // cout << "On way back up, curnode:" << curnode<< ",
     // lowlink:"<<lowlink[curnode]<< ", dfsnum:"<<dfsnum[curnode]<<endl;
@@ -1215,7 +1155,8 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
   // use push_back to push, front() and pop_front() to pop.
 
   // Also use invprevious to record which values are matched.
-  // (recording val-domMin)
+  // (recording val-domMin), and valvarmatching to find the variable a value
+  // is matched to. Both are only valid within the SCC being repaired.
 
   inline bool bfsmatching(SysInt sccstart, SysInt sccend) {
     // construct the set of matched values.
@@ -1224,6 +1165,7 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
       SysInt var = SCCs[sccindex];
       if(varArray[var].inDomain(varvalmatching[var])) {
         invprevious.insert(varvalmatching[var] - domMin);
+        valvarmatching[varvalmatching[var] - domMin] = var;
       }
     }
 
@@ -1275,6 +1217,7 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
                     D_ASSERT(varvalmatching[unwindvar] != unwindval);
 
                     varvalmatching[unwindvar] = checked_cast<SysInt>(unwindval);
+                    valvarmatching[checked_cast<SysInt>(unwindval - domMin)] = unwindvar;
                     P("Setting var " << unwindvar << " to " << unwindval);
 
                     if(unwindvar == startvar) {
@@ -1294,14 +1237,9 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
                   cout << endl;
 #endif
 
-                  invprevious.clear(); // THIS SHOULD BE CHANGED -- RECOMPUTING
-                                       // THIS EVERY TIME IS STUPID.
-                  for(SysInt sccindex = sccstart; sccindex <= sccend; sccindex++) {
-                    SysInt var = SCCs[sccindex];
-                    if(varArray[var].inDomain(varvalmatching[var])) {
-                      invprevious.insert(varvalmatching[var] - domMin);
-                    }
-                  }
+                  // Every value on the path stays matched, apart from the
+                  // free value at the end which is now matched too.
+                  invprevious.insert(checked_cast<SysInt>(val - domMin));
 
                   finished = true;
                   break; // get out of for loop
@@ -1318,26 +1256,10 @@ struct GacAlldiffConstraint : public FlowConstraint<VarArray, UseIncGraph> {
                    // matching.
             D_ASSERT(curnode >= numvars && curnode < numvars + numvals);
             DomainInt stackval = curnode + domMin - numvars;
-            SysInt vartoqueue = -1;
-            D_DATA(bool found = false);
-#if !UseIncGraph
-            for(SysInt scci = sccstart; scci <= sccend; scci++) {
-              vartoqueue = SCCs[scci];
-#else
-            for(SysInt vartoqueuei = 0; vartoqueuei < adjlistlength[curnode]; vartoqueuei++) {
-              vartoqueue = adjlist[curnode][vartoqueuei];
-#endif
-              if(varvalmatching[vartoqueue] == stackval
-#if !UseIncGraph
-                 && varArray[vartoqueue].inDomain(stackval)
-#endif
-              ) {
-                D_DATA(found = true);
-                break;
-              }
-            }
-            D_ASSERT(found);            // if this assertion fails, then invprevious must
-                                        // be wrong.
+            SysInt vartoqueue = valvarmatching[curnode - numvars];
+            // if this assertion fails, then invprevious must be wrong.
+            D_ASSERT(varvalmatching[vartoqueue] == stackval);
+            D_ASSERT(varArray[vartoqueue].inDomain(stackval));
             if(!visited.in(vartoqueue)) // I think it's impossible for this
                                         // test to be false.
             {
@@ -268,30 +268,36 @@ protected:
     // to_process.reserve(varArray.size()); Could this be shared as well??
 
     if(UseIncGraph) {
-      // refactor this to use initial upper and lower bounds.
-      adjlist.resize(numvars + numvals);
-      adjlistpos.resize(numvars + numvals);
+      // One edge for each value in the initial bounds of each variable, so
+      // the graph is only as big as the domains rather than
+      // numvars*numvals.
+      edgeStart.resize(numvars + 1);
+      varInitMin.resize(numvars);
+      edgeStart[0] = 0;
       for(SysInt i = 0; i < numvars; i++) {
-        adjlist[i].resize(numvals);
-        for(SysInt j = 0; j < numvals; j++)
-          adjlist[i][j] = j + domMin;
-        adjlistpos[i].resize(numvals);
-        for(SysInt j = 0; j < numvals; j++)
-          adjlistpos[i][j] = j;
+        varInitMin[i] = checked_cast<SysInt>(varArray[i].initialMin());
+        edgeStart[i + 1] =
+            edgeStart[i] + checked_cast<SysInt>(varArray[i].initialMax()) - varInitMin[i] + 1;
       }
-      for(SysInt i = numvars; i < numvars + numvals; i++) {
-        adjlist[i].resize(numvars);
-        for(SysInt j = 0; j < numvars; j++)
-          adjlist[i][j] = j;
-        adjlistpos[i].resize(numvars);
-        for(SysInt j = 0; j < numvars; j++)
-          adjlistpos[i][j] = j;
+      edgeVar.resize(edgeStart[numvars]);
+      varValPos.resize(edgeStart[numvars]);
+      valVarPos.resize(edgeStart[numvars]);
+
+      adjlist.resize(numvars + numvals);
+      for(SysInt i = 0; i < numvars; i++) {
+        for(SysInt e = edgeStart[i]; e < edgeStart[i + 1]; e++) {
+          SysInt val = e - edgeStart[i] + varInitMin[i];
+          SysInt validx = val - domMin + numvars;
+          edgeVar[e] = i;
+          varValPos[e] = adjlist[i].size();
+          adjlist[i].push_back(val);
+          valVarPos[e] = adjlist[validx].size();
+          adjlist[validx].push_back(i);
+        }
       }
       adjlistlength = getMemory().backTrack().template requestArray<SysInt>(numvars + numvals);
-      for(SysInt i = 0; i < numvars; i++)
-        adjlistlength[i] = numvals;
-      for(SysInt i = numvars; i < numvars + numvals; i++)
-        adjlistlength[i] = numvars;
+      for(SysInt i = 0; i < numvars + numvals; i++)
+        adjlistlength[i] = adjlist[i].size();
     }
 
 #ifndef BTMATCHING
@@ -325,16 +331,46 @@ protected:
   // domain of the variable, or variables with val in their domain.
   vector<vector<SysInt>> adjlist;
   SysInt* adjlistlength;
-  vector<vector<SysInt>> adjlistpos; // position of a variable in adjlist.
+
+  // The edges of variable i are numbered edgeStart[i] .. edgeStart[i+1]-1,
+  // one for each value in its initial bounds, starting at varInitMin[i].
+  vector<SysInt> edgeStart;
+  vector<SysInt> varInitMin;
+  vector<SysInt> edgeVar;   // the variable of each edge.
+  vector<SysInt> varValPos; // position of the value in adjlist[var].
+  vector<SysInt> valVarPos; // position of the variable in adjlist[val].
+
+  inline SysInt numEdges() {
+    return edgeStart[numvars];
+  }
+
+  // Is val in the initial bounds of var, so there is an edge for it?
+  inline bool hasEdge(SysInt var, SysInt val) {
+    return val >= varInitMin[var] && val - varInitMin[var] < edgeStart[var + 1] - edgeStart[var];
+  }
+
+  inline SysInt edgeIndex(SysInt var, SysInt val) {
+    D_ASSERT(hasEdge(var, val));
+    return edgeStart[var] + val - varInitMin[var];
+  }
+
+  inline SysInt edgeVal(SysInt edge) {
+    return edge - edgeStart[edgeVar[edge]] + varInitMin[edgeVar[edge]];
+  }
+
+  // Is val still in the adjacency list of var?
+  inline bool adjlist_in(SysInt var, SysInt val) {
+    return hasEdge(var, val) && varValPos[edgeIndex(var, val)] < adjlistlength[var];
+  }
 
   inline void adjlist_remove(SysInt var, SysInt val) {
     // swap item at position varidx to the end, then reduce the length by 1.
     SysInt validx = val - domMin + numvars;
-    SysInt varidx = adjlistpos[validx][var];
-    D_ASSERT(varidx < adjlistlength[validx]); // var is actually in the list.
-    delfromlist(validx, varidx);
+    SysInt edge = edgeIndex(var, val);
+    D_ASSERT(valVarPos[edge] < adjlistlength[validx]); // var is actually in the list.
+    delfromlist(validx, valVarPos[edge]);
 
-    delfromlist(var, adjlistpos[var][val - domMin]);
+    delfromlist(var, varValPos[edge]);
   }
 
   inline void delfromlist(SysInt i, SysInt j) {
@@ -343,11 +379,12 @@ protected:
     adjlist[i][adjlistlength[i] - 1] = adjlist[i][j];
 
     if(i < numvars) {
-      adjlistpos[i][adjlist[i][j] - domMin] = adjlistlength[i] - 1;
-      adjlistpos[i][t - domMin] = j;
+      varValPos[edgeIndex(i, adjlist[i][j])] = adjlistlength[i] - 1;
+      varValPos[edgeIndex(i, t)] = j;
     } else {
-      adjlistpos[i][adjlist[i][j]] = adjlistlength[i] - 1;
-      adjlistpos[i][t] = j;
+      SysInt val = i - numvars + domMin;
+      valVarPos[edgeIndex(adjlist[i][j], val)] = adjlistlength[i] - 1;
+      valVarPos[edgeIndex(t, val)] = j;
     }
     adjlist[i][j] = t;
     adjlistlength[i] = adjlistlength[i] - 1;
@@ -358,9 +395,9 @@ protected:
       D_ASSERT(varArray[i].min() >= domMin);
       D_ASSERT(varArray[i].max() <= domMax);
       for(SysInt j = domMin; j <= domMax; j++) {
-        D_DATA(bool in = adjlistpos[i][j - domMin] < adjlistlength[i]);
-        D_DATA(bool in2 =
-                   adjlistpos[j - domMin + numvars][i] < adjlistlength[j - domMin + numvars]);
+        D_DATA(bool in = adjlist_in(i, j));
+        D_DATA(SysInt validx = j - domMin + numvars);
+        D_DATA(bool in2 = hasEdge(i, j) && valVarPos[edgeIndex(i, j)] < adjlistlength[validx]);
         D_ASSERT(in == in2);
         D_ASSERT(in == varArray[i].inDomain(j));
       }
@@ -942,6 +979,88 @@ protected:
     }
     augpath.clear();
   }
+
+  // ------------------------- Tarjan's algorithm ----------------------------
+  // Shared by gacalldiff and gcc. The depth-first search keeps its own stack
+  // instead of recursing, so a constraint with many variables and values
+  // cannot overflow the call stack. The graph is given by the constraint
+  // passed to tarjan_dfs, which provides:
+  //   tarjan_enter(node, parent)  node is visited first, from parent (-1 at
+  //                               the start of a search).
+  //   tarjan_next(node, pos)      the next successor of node, starting from
+  //                               position pos, which it moves past the edge
+  //                               returned. -1 when there are no more.
+  //   tarjan_lowered(node, from)  lowlink[node] was lowered by a back edge to
+  //                               from, or by a child when from is -1.
+  //   tarjan_finish(node, toplevel)  all successors of node are done. If
+  //                               lowlink[node]==dfsnum[node] then node is
+  //                               the root of an SCC, still on tstack.
+
+  vector<SysInt> tstack;
+  smallset_nolist in_tstack;
+  smallset_nolist visited;
+  vector<SysInt> dfsnum;
+  vector<SysInt> lowlink;
+  SysInt maxDfs;
+
+  vector<SysInt> curnodestack; // the path from the start of the search.
+  vector<SysInt> succpos;      // position in the successors of each node.
+
+  void initialize_tarjan_stacks() {
+    SysInt numnodes = numvars + numvals + 1; // One sink node.
+    tstack.reserve(numnodes);
+    in_tstack.reserve(numnodes);
+    visited.reserve(numnodes);
+    maxDfs = 1;
+    dfsnum.resize(numnodes);
+    lowlink.resize(numnodes);
+    curnodestack.reserve(numnodes);
+    succpos.resize(numnodes);
+  }
+
+  template <typename Graph>
+  inline void tarjan_push(Graph* g, SysInt node, SysInt parent) {
+    tstack.push_back(node);
+    in_tstack.insert(node);
+    dfsnum[node] = maxDfs;
+    lowlink[node] = maxDfs;
+    maxDfs++;
+    visited.insert(node);
+    succpos[node] = 0;
+    curnodestack.push_back(node);
+    g->tarjan_enter(node, parent);
+  }
+
+  template <typename Graph>
+  void tarjan_dfs(Graph* g, SysInt start) {
+    D_ASSERT(curnodestack.empty());
+    tarjan_push(g, start, -1);
+    while(!curnodestack.empty()) {
+      SysInt curnode = curnodestack.back();
+      SysInt newnode = g->tarjan_next(curnode, succpos[curnode]);
+      if(newnode != -1) {
+        if(!visited.in(newnode)) {
+          tarjan_push(g, newnode, curnode);
+        } else if(in_tstack.in(newnode) && dfsnum[newnode] < lowlink[curnode]) {
+          // Already visited newnode
+          lowlink[curnode] = dfsnum[newnode];
+          g->tarjan_lowered(curnode, newnode);
+        }
+        continue;
+      }
+
+      curnodestack.pop_back();
+      bool toplevel = curnodestack.empty();
+      g->tarjan_finish(curnode, toplevel);
+      if(!toplevel) {
+        SysInt parent = curnodestack.back();
+        if(lowlink[curnode] < lowlink[parent]) {
+          lowlink[parent] = lowlink[curnode];
+          g->tarjan_lowered(parent, -1);
+        }
+      }
+    }
+  }
 };
 
 struct deque_fixedSize {
@@ -74,6 +74,13 @@ struct arrayset {
   void fill() {
     size = vals.size();
   }
+
+  /// Adds to b each member which lies inside the range b can hold.
+  void copyInto(DomainBitset& b) const {
+    for(SysInt i = 0; i < size; i++)
+      if(vals[i] >= b.base && vals[i] <= b.maxValue())
+        b.insert(vals[i]);
+  }
 };
 
 #endif
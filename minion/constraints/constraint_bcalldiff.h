@@ -0,0 +1,474 @@
+/*
+ * Minion http://minion.sourceforge.net
+ * Copyright (C) 2006-09
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+/** @help constraints;bcalldiff Description
+Forces the input vector of variables to take distinct values, enforcing
+bounds consistency.
+*/
+
+/** @help constraints;bcalldiff Example
+Suppose the input file had the following vector of variables defined:
+
+DISCRETE myVec[9] {1..9}
+
+To ensure that each variable takes a different value include the
+following constraint:
+
+bcalldiff(myVec)
+*/
+
+/** @help constraints;bcalldiff Notes
+This constraint uses the Hall interval algorithm of Lopez-Ortiz, Quimper,
+Tromp and van Beek, which takes O(n log n) time and only looks at the bounds
+of the variables. It never creates a representation of the domains, so it is
+suitable for BOUND variables with large domains, where gacalldiff is slow and
+alldiff is weak.
+*/
+
+/** @help constraints;rcalldiff Description
+Forces the input vector of variables to take distinct values, enforcing
+range consistency.
+*/
+
+/** @help constraints;rcalldiff Notes
+Range consistency removes every value in a Hall interval from the variables
+whose bounds are not inside it, including values in the middle of a domain.
+It is stronger than bcalldiff on DISCRETE variables and weaker than
+gacalldiff, and takes O(n^2 log n) time plus the time to remove values. On
+BOUND variables it is the same as bcalldiff.
+*/
+
+#ifndef CONSTRAINT_BCALLDIFF_H
+#define CONSTRAINT_BCALLDIFF_H
+
+#include "constraint_checkassign.h"
+
+/// alldiff by Hall intervals. If RangeConsistency is false this enforces
+/// bounds consistency, otherwise range consistency.
+template <typename VarArray, bool RangeConsistency>
+struct BoundsAlldiffConstraint : public AbstractConstraint {
+  virtual string constraintName() {
+    return RangeConsistency ? "rcalldiff" : "bcalldiff";
+  }
+
+  typedef typename VarArray::value_type VarRef;
+
+  VarArray varArray;
+
+  CONSTRAINT_ARG_LIST1(varArray);
+
+  struct Interval {
+    DomainInt min, max;
+    SysInt minrank, maxrank;
+  };
+
+  // The bounds of each variable, as seen by the last propagation.
+  vector<Interval> iv;
+  // Positions of iv, sorted by min and by max. These are kept between calls
+  // and fixed up by insertion sort, as bounds only change a little at a time.
+  vector<SysInt> minsorted;
+  vector<SysInt> maxsorted;
+
+  // Workspace for the Hall interval algorithm. bounds holds the distinct
+  // values of min and max+1, in increasing order.
+  vector<DomainInt> bounds;
+  vector<SysInt> t;    // tree links
+  vector<DomainInt> d; // differences between critical capacities
+  vector<SysInt> h;    // Hall interval links
+  SysInt nb;
+
+  bool constraintLocked;
+
+  BoundsAlldiffConstraint(const VarArray& _varArray)
+      : varArray(_varArray), nb(0), constraintLocked(false) {
+    const SysInt n = varArray.size();
+    iv.resize(n);
+    minsorted.resize(n);
+    maxsorted.resize(n);
+    for(SysInt i = 0; i < n; ++i)
+      minsorted[i] = maxsorted[i] = i;
+    bounds.resize(2 * n + 2);
+    t.resize(2 * n + 2);
+    d.resize(2 * n + 2);
+    h.resize(2 * n + 2);
+  }
+
+  virtual SysInt dynamicTriggerCount() {
+    return varArray.size() * 2;
+  }
+
+  void setupTriggers() {
+    const SysInt n = varArray.size();
+    for(SysInt i = 0; i < n; ++i) {
+      moveTriggerInt(varArray[i], i, LowerBound);
+      moveTriggerInt(varArray[i], n + i, UpperBound);
+    }
+  }
+
+  virtual AbstractConstraint* reverseConstraint() {
+    return forwardCheckNegation(this);
+  }
+
+  virtual void propagateDynInt(SysInt, DomainDelta) {
+    PROP_INFO_ADDONE(BoundsAlldiff);
+    if(!constraintLocked) {
+      constraintLocked = true;
+      getQueue().pushSpecialTrigger(this);
+    }
+  }
+
+  virtual void specialUnlock() {
+    constraintLocked = false;
+  }
+
+  virtual void specialCheck() {
+    constraintLocked = false;
+    if(getState().isFailed())
+      return;
+    propagate();
+  }
+
+  virtual void fullPropagate() {
+    setupTriggers();
+    propagate(true);
+  }
+
+  void propagate(bool fullSort = false) {
+    const SysInt n = varArray.size();
+    if(n == 0)
+      return;
+    for(SysInt i = 0; i < n; ++i) {
+      iv[i].min = varArray[i].min();
+      iv[i].max = varArray[i].max();
+    }
+    sortIntervals(fullSort);
+
+    if(RangeConsistency) {
+      filterRanges();
+      return;
+    }
+
+    if(!filterLower() || !filterUpper()) {
+      getState().setFailed(true);
+      return;
+    }
+
+    for(SysInt i = 0; i < n; ++i) {
+      varArray[i].setMin(iv[i].min);
+      varArray[i].setMax(iv[i].max);
+    }
+  }
+
+  template <typename Compare>
+  void insertionSort(vector<SysInt>& order, Compare less) {
+    for(SysInt i = 1; i < (SysInt)order.size(); ++i) {
+      SysInt x = order[i];
+      SysInt j = i;
+      while(j > 0 && less(x, order[j - 1])) {
+        order[j] = order[j - 1];
+        --j;
+      }
+      order[j] = x;
+    }
+  }
+
+  // Sorts minsorted and maxsorted, and fills in bounds and the ranks of
+  // each interval in it. Unless fullSort is set, the orders are assumed to
+  // be nearly sorted already.
+  void sortIntervals(bool fullSort) {
+    const SysInt n = varArray.size();
+    auto minLess = [this](SysInt a, SysInt b) { return iv[a].min < iv[b].min; };
+    auto maxLess = [this](SysInt a, SysInt b) { return iv[a].max < iv[b].max; };
+    if(fullSort) {
+      std::sort(minsorted.begin(), minsorted.end(), minLess);
+      std::sort(maxsorted.begin(), maxsorted.end(), maxLess);
+    } else {
+      insertionSort(minsorted, minLess);
+      insertionSort(maxsorted, maxLess);
+    }
+
+    DomainInt min = iv[minsorted[0]].min;
+    DomainInt max = iv[maxsorted[0]].max + 1;
+    DomainInt last = min - 2;
+    SysInt nbounds = 0;
+    bounds[0] = last;
+    SysInt i = 0, j = 0;
+    while(true) {
+      if(i < n && min <= max) {
+        if(min != last)
+          bounds[++nbounds] = last = min;
+        iv[minsorted[i]].minrank = nbounds;
+        if(++i < n)
+          min = iv[minsorted[i]].min;
+      } else {
+        if(max != last)
+          bounds[++nbounds] = last = max;
+        iv[maxsorted[j]].maxrank = nbounds;
+        if(++j == n)
+          break;
+        max = iv[maxsorted[j]].max + 1;
+      }
+    }
+    nb = nbounds;
+    bounds[nb + 1] = bounds[nb] + 2;
+  }
+
+  static void pathSet(vector<SysInt>& links, SysInt start, SysInt end, SysInt to) {
+    SysInt k, l = start;
+    while((k = l) != end) {
+      l = links[k];
+      links[k] = to;
+    }
+  }
+
+  static SysInt pathMin(const vector<SysInt>& links, SysInt i) {
+    while(links[i] < i)
+      i = links[i];
+    return i;
+  }
+
+  static SysInt pathMax(const vector<SysInt>& links, SysInt i) {
+    while(links[i] > i)
+      i = links[i];
+    return i;
+  }
+
+  // Raises the lower bounds of iv. Returns false if there is no solution.
+  bool filterLower() {
+    const SysInt n = varArray.size();
+    for(SysInt i = 1; i <= nb + 1; ++i) {
+      t[i] = h[i] = i - 1;
+      d[i] = bounds[i] - bounds[i - 1];
+    }
+    for(SysInt i = 0; i < n; ++i) {
+      Interval& in = iv[maxsorted[i]];
+      SysInt x = in.minrank;
+      SysInt y = in.maxrank;
+      SysInt z = pathMax(t, x + 1);
+      SysInt j = t[z];
+      d[z]--;
+      if(d[z] == 0) {
+        t[z] = z + 1;
+        z = pathMax(t, t[z]);
+        t[z] = j;
+      }
+      pathSet(t, x + 1, z, z);
+      if(d[z] < bounds[z] - bounds[y])
+        return false;
+      if(h[x] > x) {
+        SysInt w = pathMax(h, h[x]);
+        in.min = bounds[w];
+        pathSet(h, x, w, w);
+      }
+      if(d[z] == bounds[z] - bounds[y]) {
+        pathSet(h, h[y], j - 1, y);
+        h[y] = j - 1;
+      }
+    }
+    return true;
+  }
+
+  // Lowers the upper bounds of iv. Returns false if there is no solution.
+  bool filterUpper() {
+    const SysInt n = varArray.size();
+    for(SysInt i = 0; i <= nb; ++i) {
+      t[i] = h[i] = i + 1;
+      d[i] = bounds[i + 1] - bounds[i];
+    }
+    for(SysInt i = n - 1; i >= 0; --i) {
+      Interval& in = iv[minsorted[i]];
+      SysInt x = in.maxrank;
+      SysInt y = in.minrank;
+      SysInt z = pathMin(t, x - 1);
+      SysInt j = t[z];
+      d[z]--;
+      if(d[z] == 0) {
+        t[z] = z - 1;
+        z = pathMin(t, t[z]);
+        t[z] = j;
+      }
+      pathSet(t, x - 1, z, z);
+      if(d[z] < bounds[y] - bounds[z])
+        return false;
+      if(h[x] < x) {
+        SysInt w = pathMin(h, h[x]);
+        in.max = bounds[w] - 1;
+        pathSet(h, x, w, w);
+      }
+      if(d[z] == bounds[y] - bounds[z]) {
+        pathSet(h, h[y], j + 1, y);
+        h[y] = j + 1;
+      }
+    }
+    return true;
+  }
+
+  // Finds every Hall interval [a,b], where a is the min of some variable and
+  // b is the max of some variable, and the number of variables whose bounds
+  // are inside [a,b] is b - a + 1. Then every value of a Hall interval is
+  // removed from the variables which are not inside it.
+  void filterRanges() {
+    const SysInt n = varArray.size();
+    // For each distinct start a, in increasing order, the ends of the Hall
+    // intervals starting at a, in increasing order.
+    vector<DomainInt> hallStart;
+    vector<vector<DomainInt>> hallEnds;
+
+    for(SysInt ai = 0; ai < n; ++ai) {
+      DomainInt a = iv[minsorted[ai]].min;
+      if(ai > 0 && a == iv[minsorted[ai - 1]].min)
+        continue;
+      SysInt count = 0;
+      for(SysInt j = 0; j < n; ++j) {
+        const Interval& in = iv[maxsorted[j]];
+        if(in.max < a)
+          continue;
+        if(in.max - a + 1 > n)
+          break;
+        if(in.min >= a)
+          count++;
+        if(j + 1 < n && iv[maxsorted[j + 1]].max == in.max)
+          continue;
+        if(count > in.max - a + 1) {
+          getState().setFailed(true);
+          return;
+        }
+        if(count > 0 && count == in.max - a + 1) {
+          if(hallStart.empty() || hallStart.back() != a) {
+            hallStart.push_back(a);
+            hallEnds.push_back(vector<DomainInt>());
+          }
+          hallEnds.back().push_back(in.max);
+        }
+      }
+    }
+
+    if(hallStart.empty())
+      return;
+
+    vector<pair<DomainInt, DomainInt>> prune;
+    for(SysInt i = 0; i < n; ++i) {
+      const DomainInt lo = iv[i].min;
+      const DomainInt hi = iv[i].max;
+      // The Hall intervals starting at a which do not contain [lo,hi] are
+      // those which start after lo, or end before hi. Only the largest of
+      // them matters.
+      prune.clear();
+      for(SysInt k = 0; k < (SysInt)hallStart.size() && hallStart[k] <= hi; ++k) {
+        const DomainInt a = hallStart[k];
+        const vector<DomainInt>& ends = hallEnds[k];
+        DomainInt b;
+        if(a > lo)
+          b = ends.back();
+        else {
+          vector<DomainInt>::const_iterator it = std::lower_bound(ends.begin(), ends.end(), hi);
+          if(it == ends.begin())
+            continue;
+          b = *(it - 1);
+        }
+        if(b < lo)
+          continue;
+        if(!prune.empty() && a <= prune.back().second + 1)
+          prune.back().second = std::max(prune.back().second, b);
+        else
+          prune.push_back(make_pair(a, b));
+      }
+
+      for(SysInt k = 0; k < (SysInt)prune.size(); ++k) {
+        const DomainInt a = prune[k].first;
+        const DomainInt b = prune[k].second;
+        if(a <= lo)
+          varArray[i].setMin(b + 1);
+        else if(b >= hi)
+          varArray[i].setMax(a - 1);
+        else if(!varArray[i].isBound()) {
+          for(DomainInt v = a; v <= b; ++v)
+            varArray[i].removeFromDomain(v);
+        }
+      }
+    }
+  }
+
+  virtual BOOL checkAssignment(DomainInt* v, SysInt vSize) {
+    D_ASSERT(vSize == (SysInt)varArray.size());
+    for(SysInt i = 0; i < vSize; i++)
+      for(SysInt j = i + 1; j < vSize; j++)
+        if(v[i] == v[j])
+          return false;
+    return true;
+  }
+
+  virtual vector<AnyVarRef> getVars() {
+    vector<AnyVarRef> vars;
+    vars.reserve(varArray.size());
+    for(UnsignedSysInt i = 0; i < varArray.size(); ++i)
+      vars.push_back(varArray[i]);
+    return vars;
+  }
+
+  // As for alldiff, finding a full assignment would need a matching.
+  virtual bool getSatisfyingAssignment(box<pair<SysInt, DomainInt>>& assignment) {
+    MAKE_STACK_BOX(c, DomainInt, varArray.size());
+
+    for(UnsignedSysInt i = 0; i < varArray.size(); ++i) {
+      if(!varArray[i].isAssigned()) {
+        assignment.push_back(make_pair(i, varArray[i].min()));
+        assignment.push_back(make_pair(i, varArray[i].max()));
+        return true;
+      } else
+        c.push_back(varArray[i].assignedValue());
+    }
+
+    if(checkAssignment(c.begin(), c.size())) {
+      for(SysInt i = 0; i < (SysInt)varArray.size(); ++i)
+        assignment.push_back(make_pair(i, c[i]));
+      return true;
+    }
+    return false;
+  }
+};
+
+template <typename VarArray>
+AbstractConstraint* BuildCT_BCALLDIFF(const VarArray& varArray, ConstraintBlob&) {
+  return new BoundsAlldiffConstraint<VarArray, false>(varArray);
+}
+
+/* JSON
+{ "type": "constraint",
+  "name": "bcalldiff",
+  "internal_name": "CT_BCALLDIFF",
+  "args": [ "read_list" ]
+}
+*/
+
+template <typename VarArray>
+AbstractConstraint* BuildCT_RCALLDIFF(const VarArray& varArray, ConstraintBlob&) {
+  return new BoundsAlldiffConstraint<VarArray, true>(varArray);
+}
+
+/* JSON
+{ "type": "constraint",
+  "name": "rcalldiff",
+  "internal_name": "CT_RCALLDIFF",
+  "args": [ "read_list" ]
+}
+*/
+
+#endif
@@ -73,6 +73,72 @@ public:
   }
 };
 
+// Collects the variables whose domains change. This is not added to the
+// list of constraints: it is set up and triggered directly, so it is never
+// checked or counted against the variables by the search.
+template <typename VarArrayType>
+struct CollectChanges : public AbstractConstraint {
+  VarArrayType varArray;
+
+public:
+  vector<char> changed;
+  vector<SysInt> changedList;
+
+  CollectChanges(const VarArrayType& _varArray)
+      : varArray(_varArray), changed(_varArray.size(), 0) {}
+
+  virtual string constraintName() {
+    return "collectchanges";
+  }
+
+  CONSTRAINT_ARG_LIST1(varArray);
+
+  SysInt dynamicTriggerCount() {
+    return varArray.size();
+  }
+
+  void mark(SysInt i) {
+    if(!changed[i]) {
+      changed[i] = 1;
+      changedList.push_back(i);
+    }
+  }
+
+  virtual void propagateDynInt(SysInt trig, DomainDelta) {
+    mark(trig);
+  }
+
+  virtual void fullPropagate() {
+    for(SysInt i = 0; i < (SysInt)varArray.size(); i++) {
+      moveTriggerInt(varArray[i], i, DomainChanged);
+    }
+  }
+
+  virtual BOOL checkAssignment(DomainInt* v, SysInt arraySize) {
+    return true;
+  }
+
+  virtual vector<AnyVarRef> getVars() {
+    vector<AnyVarRef> vars;
+    vars.reserve(varArray.size());
+    for(UnsignedSysInt i = 0; i < varArray.size(); ++i)
+      vars.push_back(varArray[i]);
+    return vars;
+  }
+
+  void clear() {
+    for(SysInt i = 0; i < (SysInt)changedList.size(); ++i)
+      changed[changedList[i]] = 0;
+    changedList.clear();
+  }
+
+  void releaseTriggers() {
+    for(SysInt i = 0; i < (SysInt)varArray.size(); i++) {
+      releaseTriggerInt(i);
+    }
+  }
+};
+
 template <typename VarArray>
 AbstractConstraint* BuildCT_COLLECTEVENTS(const VarArray& varArray, ConstraintBlob& b) {
   return new CollectEvents<VarArray>(varArray);
@@ -74,6 +74,9 @@ struct LightTableConstraint : public AbstractConstraint {
   TableDataType* data; // Assuming this is a TrieData for the time being.
   // Can this be the thing instead of a *??
 
+  // Scratch space for pruning, reused to avoid allocating each time.
+  vector<DomainInt> unsupported;
+
   LightTableConstraint(const VarArray& _vars, TupleList* _tuples)
       : vars(_vars), tuples(_tuples), data(new TableDataType(_tuples)) {
     CheckNotBound(vars, "table constraints", "");
@@ -105,20 +108,16 @@ struct LightTableConstraint : public AbstractConstraint {
 
   void propagateVar(SysInt varidx) {
     VarRef var = vars[varidx];
-
-    for(DomainInt val = var.min(); val <= var.max(); val++) {
-      if(var.inDomain(val)) {
-        // find the right trie first.
-
-        TupleTrie& trie = data->tupleTrieArrayptr->getTrie(varidx);
-
-        bool support = trie.searchTrie_nostate(val, vars);
-
-        if(!support) {
-          var.removeFromDomain(val);
-        }
-      }
-    }
+    TupleTrie& trie = data->tupleTrieArrayptr->getTrie(varidx);
+
+    // Only other variables are looked at in the trie, so the values
+    // without support can all be removed together at the end.
+    unsupported.clear();
+    var.forEachValue([&](DomainInt val) {
+      if(!trie.searchTrie_nostate(val, vars))
+        unsupported.push_back(val);
+    });
+    var.removeValues(unsupported);
   }
 
   virtual void fullPropagate() {
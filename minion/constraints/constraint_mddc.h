@@ -22,6 +22,19 @@
 
 
 
+/** @help constraints;mddc Description
+MDDC (mddc) is an implementation of MDDC(sp) by Cheng and Yap.
+It enforces GAC on a constraint using a multi-valued decision diagram (MDD).
+
+The MDD required for the propagator is constructed from a set of satisfying
+tuples, or can be given directly in an **MDD** section of the input. The
+constraint has the same syntax as 'table' and can function as a drop-in
+replacement.
+
+The MDD built from a tuplelist is reduced (equal subgraphs are merged)
+and shared between all mddc constraints which use the same tuplelist.
+*/
+
 /** @help constraints;negativemddc Description
 Negative MDDC (negativemddc) is an implementation of MDDC(sp) by Cheng and Yap.
 It enforces GAC on a constraint using a multi-valued decision diagram (MDD).
@@ -128,15 +141,6 @@ struct arrayset_bt {
   }
 };
 
-struct MDDNode {
-  MDDNode(MDDNode* _parent, char _type) : parent(_parent), type(_type) {}
-
-  MDDNode* parent;
-  vector<std::pair<DomainInt, MDDNode*>> links; // pairs val,next
-  SysInt id;                                    // Integer that uniquely defines this node.
-  char type;                                    //   -1 is tt, 0 is normal, -2 is ff.
-};
-
 template <typename VarArray, bool isNegative = false>
 struct MDDC : public AbstractConstraint {
   virtual string constraintName() {
@@ -158,14 +162,18 @@ struct MDDC : public AbstractConstraint {
 
   TupleList* tuples;
 
-  // All nodes of the mdd, used for freeing.
-  vector<MDDNode*> mddnodes;
+  // The mdd. For positive tables this is shared with every other constraint
+  // on the same TupleList.
+  MDD* mdd;
 
   MDDNode* top;
 
   vector<arrayset> gacvalues; // Opposite of the sets in the Cheng and Yap
                               // paper: these start empty and are fille d
 
+  // Scratch space for pruning, reused to avoid allocating each time.
+  DomainBitset supported;
+
   MDDC(const VarArray& _varArray, TupleList* _tuples)
       :
 
@@ -176,13 +184,14 @@ struct MDDC : public AbstractConstraint {
     if(isNegative) {
       initNegative(_tuples);
     } else {
-      init(_tuples);
+      mdd = _tuples->getMDD();
     }
+    top = mdd->top;
 
     // set up the two sets of mdd nodes.
 
-    gyes.initialise(0, (SysInt)mddnodes.size() - 1);
-    gno.initialise(0, (SysInt)mddnodes.size() - 1);
+    gyes.initialise(0, mdd->size() - 1);
+    gno.initialise(0, mdd->size() - 1);
 
     // Set up gacvalues.
 
@@ -192,106 +201,6 @@ struct MDDC : public AbstractConstraint {
     }
   }
 
-  //
-  // This one accepted an mdd written in a fairly difficult format.
-  /*void old_init(TupleList* tuples) {
-      // convert tuples into mdd nodes
-      int tlsize=tuples->size();
-
-      int tuplelen=tuples->tupleSize();
-
-      DomainInt* tupdata=tuples->getPointer();
-
-      CHECK(tuplelen%2 == 0, "Tuples must be even length in MDDC");  // Check it
-  is even length.
-
-      mddnodes.resize(tlsize);
-
-      for(int nodeid=0; nodeid<tlsize; nodeid++) {
-          vector<DomainInt> tup(tupdata+(tuplelen*nodeid),
-  tupdata+(tuplelen*(nodeid+1) ));   // inefficient.
-
-          if(nodeid<tlsize-1) {
-              // Not final tt node.
-              for(int pair=0; pair<(SysInt)tup.size(); pair=pair+2) {
-                  if(tup[pair]==-1 && tup[pair+1]==-1) break;
-
-                  CHECK(tup[pair+1] >0 && tup[pair+1]<tlsize, "Links in MDD must
-  be in range 1 up to the number of nodes");
-
-                  mddnodes[nodeid].links.push_back(std::make_pair(tup[pair],
-  checked_cast<SysInt>(tup[pair+1])));  // push the domain value
-              }
-
-              mddnodes[nodeid].id=nodeid;
-
-          }
-          else {
-              // Final tt node.
-              CHECK(tup[0]==-1 && tup[1]==-1, "Final MDD node must be all -1s,
-  cannot link to any other nodes.");
-              mddnodes[nodeid].id=-1;
-          }
-      }
-  }*/
-
-  // This one converts a list of tuples (i.e. a standard table constraint) to an
-  // mdd.
-  void init(TupleList* tuples) {
-    // First build a trie by inserting the tuples one by one.
-
-    SysInt tlsize = checked_cast<SysInt>(tuples->size());
-
-    SysInt tuplelen = checked_cast<SysInt>(tuples->tupleSize());
-
-    DomainInt* tupdata = tuples->getPointer();
-
-    // Make the top node.
-    top = new MDDNode(NULL, 0);
-    mddnodes.push_back(top);
-
-    for(int tupid = 0; tupid < tlsize; tupid++) {
-      vector<DomainInt> tup(tupdata + (tuplelen * tupid),
-                            tupdata + (tuplelen * (tupid + 1))); // inefficient.
-
-      MDDNode* curnode = top;
-
-      for(int i = 0; i < tuplelen; i++) {
-        // Search for value.
-        vector<std::pair<DomainInt, MDDNode*>>& links = curnode->links;
-
-        int idx = findLink(links, tup[i]);
-
-        if(idx == -1) {
-          // New node needed.
-          MDDNode* newnode = new MDDNode(curnode, 0);
-          if(i == tuplelen - 1) {
-            newnode->type = -1; // At the end of the tuple -- make a tt node.
-          }
-          mddnodes.push_back(newnode);
-
-          mklink(curnode, newnode, tup[i]);
-
-          // Move to this new node.
-          curnode = newnode;
-        } else {
-          // Follow the link.
-          curnode = links[idx].second;
-        }
-      }
-      D_ASSERT(curnode->type == -1); // tt node.
-    }
-
-    // Now mdd is a trie with lots of tt nodes as the leaves.
-    // Start merging from the leaves upwards.
-    // label the nodes with a unique integer.
-    for(int i = 0; i < (SysInt)mddnodes.size(); i++) {
-      mddnodes[i]->id = i;
-    }
-
-    compress_from_leaves();
-  }
-
   // This one converts a negative list of tuples (i.e. a negative table
   // constraint) to an mdd.
   void initNegative(TupleList* tuples) {
@@ -304,14 +213,13 @@ struct MDDC : public AbstractConstraint {
     DomainInt* tupdata = tuples->getPointer();
 
     // Make the top node.
-    top = new MDDNode(NULL, -1); // Start with just a tt node.
-    mddnodes.push_back(top);
+    MDDNode* root = new MDDNode(-1); // Start with just a tt node.
 
     for(int tupid = 0; tupid < tlsize; tupid++) {
       vector<DomainInt> tup(tupdata + (tuplelen * tupid),
                             tupdata + (tuplelen * (tupid + 1))); // inefficient.
 
-      MDDNode* curnode = top;
+      MDDNode* curnode = root;
 
       for(int i = 0; i < tuplelen; i++) {
         // Search for value.
@@ -333,16 +241,14 @@ struct MDDC : public AbstractConstraint {
           for(DomainInt val = vars[i].initialMin(); val <= vars[i].initialMax(); val++) {
             if(val == tupval) {
               // Make the next node in the tuple.
-              newnode = new MDDNode(curnode, 0);
+              newnode = new MDDNode(0);
               if(i == tuplelen - 1) {
                 newnode->type = -2; // At the end of the tuple -- make it an ff node.
               }
-              mddnodes.push_back(newnode);
               mklink(curnode, newnode, val);
             } else {
               // Make a tt node.
-              MDDNode* tempnode = new MDDNode(curnode, -1);
-              mddnodes.push_back(tempnode);
+              MDDNode* tempnode = new MDDNode(-1);
               mklink(curnode, tempnode, val);
             }
           }
@@ -362,14 +268,10 @@ struct MDDC : public AbstractConstraint {
       }
       D_ASSERT(curnode->type == -2); // ff node at end of tuple.
     }
-    // Now mdd is a trie with lots of tt nodes as the leaves.
-    // Start merging from the leaves upwards.
-    // label the nodes with a unique integer.
-    for(int i = 0; i < (SysInt)mddnodes.size(); i++) {
-      mddnodes[i]->id = i;
-    }
-
-    compress_from_leaves();
+    // Now mdd is a trie with lots of tt and ff nodes as the leaves.
+    // Merge equal subtrees from the leaves upwards.
+    MDDBuilder builder(tuplelen);
+    mdd = builder.finish(builder.reduce(root));
   }
 
   void mklink(MDDNode* curnode, MDDNode* newnode, DomainInt value) {
@@ -391,85 +293,6 @@ struct MDDC : public AbstractConstraint {
     }
   }
 
-  void compress_from_leaves() {
-
-    for(int layer = vars.size(); layer >= 0; layer--) {
-      // Need a list of all nodes in this layer, with the index of their
-      // parent.
-
-      vector<MDDNode*> nodelist;
-
-      find_layer(0, layer, top, nodelist);
-
-      // Use stupid algorithm to find duplicates.
-      // Only need to look at layers 1..n where n is number of vars.
-      // Layer 0 only contains
-      for(int i = 1; i < (SysInt)nodelist.size(); i++) {
-        for(int j = i + 1; j < (SysInt)nodelist.size(); j++) {
-          bool match = true;
-          MDDNode* n1 = nodelist[i];
-          MDDNode* n2 = nodelist[j];
-
-          if(n1->type != n2->type)
-            match = false;
-          if(n1->links.size() != n2->links.size())
-            match = false;
-          for(int k = 0; k < (SysInt)(n1->links.size()) && match; k++) {
-            if(n1->links[k] != n2->links[k])
-              match = false;
-          }
-
-          if(match) {
-            // we have a match.
-            // Delete nodelist[j].
-
-            MDDNode* todelete = nodelist[j];
-            nodelist[j] = nodelist.back();
-            nodelist.pop_back();
-            j--;
-
-            mddnodes[todelete->id] = mddnodes.back();
-            mddnodes.pop_back();
-            if(todelete->id != (SysInt)mddnodes.size()) {
-              // If we didn't just delete the last element...
-              mddnodes[todelete->id]->id = todelete->id; // fix the id of the moved node.
-            }
-
-            vector<std::pair<DomainInt, MDDNode*>>& parlinks = todelete->parent->links;
-            //  Search parlinks for the pointer to change
-            for(int k = 0; k < (SysInt)parlinks.size(); k++) {
-              if(parlinks[k].second == todelete) {
-                // todelete is being deleted so rewire this pointer to
-                // nodelinks[i]
-                parlinks[k].second = nodelist[i];
-                break;
-              }
-            }
-
-            delete todelete;
-          }
-        }
-      }
-    }
-
-    // ensure nodes are labelled with unique integers.
-    for(int i = 0; i < (SysInt)mddnodes.size(); i++) {
-      D_ASSERT(mddnodes[i]->id == i);
-    }
-  }
-
-  void find_layer(int currentlayer, int targetlayer, MDDNode* curnode, vector<MDDNode*>& nodelist) {
-    if(currentlayer < targetlayer) {
-      for(int i = 0; i < (SysInt)curnode->links.size(); i++) {
-        find_layer(currentlayer + 1, targetlayer, curnode->links[i].second, nodelist);
-      }
-    } else {
-      D_ASSERT(currentlayer == targetlayer);
-
-      nodelist.push_back(curnode);
-    }
-  }
-
   virtual SysInt dynamicTriggerCount() {
     return vars.size();
   }
@@ -523,7 +346,7 @@ struct MDDC : public AbstractConstraint {
   }
 
   // Binary search for a value in a vector
-  inline SysInt findLink(vector<std::pair<DomainInt, MDDNode*>> links, DomainInt value) {
+  inline SysInt findLink(const vector<std::pair<DomainInt, MDDNode*>>& links, DomainInt value) {
     // Binary search to find the index where the first element of the pair
     // equals value.
     SysInt first = 0;
@@ -593,11 +416,9 @@ struct MDDC : public AbstractConstraint {
 
     // Prune the domains.
     for(SysInt var = 0; var < delta; var++) {
-      for(DomainInt val = vars[var].min(); val <= vars[var].max(); val++) {
-        if(!gacvalues[var].in(val)) {
-          vars[var].removeFromDomain(val);
-        }
-      }
+      supported.reset(vars[var].min(), vars[var].max());
+      gacvalues[var].copyInto(supported);
+      vars[var].intersectWith(supported);
     }
 
     // Don't need the other bits of the algorithm because Minion does it for us.
@@ -717,8 +538,8 @@ struct MDDC : public AbstractConstraint {
   }
 
   void print_mdd() {
-    for(int i = 0; i < (SysInt)mddnodes.size(); i++) {
-      print_mdd_node(mddnodes[i]);
+    for(int i = 0; i < mdd->size(); i++) {
+      print_mdd_node(mdd->nodes[i]);
     }
   }
   void print_mdd_node(MDDNode* n) {
@@ -360,6 +360,9 @@ struct STR : public AbstractConstraint {
 
   vector<arrayset> gacvalues;
 
+  // Scratch space for pruning, reused to avoid allocating each time.
+  DomainBitset supported;
+
   bool validTuple(SysInt i) {
     SysInt index = tupindices[i];
     const vector<DomainInt>& tau = sct->tuples[index];
@@ -494,11 +497,9 @@ struct STR : public AbstractConstraint {
         vars[var].setMax(new_max);
       }
       else {
-        for(DomainInt val = vars[var].min(); val <= vars[var].max(); val++) {
-          if(!gacvalues[var].in(val)) {
-            vars[var].removeFromDomain(val);
-          }
-        }
+        supported.reset(vars[var].min(), vars[var].max());
+        gacvalues[var].copyInto(supported);
+        vars[var].intersectWith(supported);
       }
     }
 
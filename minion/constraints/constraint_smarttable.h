@@ -0,0 +1,393 @@
+/*
+ * Minion http://minion.sourceforge.net
+ * Copyright (C) 2006-09
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+/** @help constraints;smarttable Description
+An extensional constraint, given as a list of smart tuples. Each smart
+tuple is a list of conditions, which are either unary (a variable is
+compared to a constant, or must be in or not in a set of values), or
+binary (two variables are compared). An assignment satisfies the
+constraint if it satisfies all the conditions of at least one smart
+tuple. Refer to the smarttuplelist page for the input format.
+
+smarttable enforces GAC, with a propagator in the style of STR2: the
+tuples which are still valid are kept in a list, and each time the
+constraint is propagated each valid tuple gives support to all the
+values it allows.
+*/
+
+/** @help constraints;smarttable Example
+
+**SMARTTUPLELIST**
+mycon 2
+[(x0 in {3..9}), (x1 != 2)]
+[(x0 < x2), (x1 = 2)]
+
+**CONSTRAINTS**
+smarttable([a,b,c], mycon)
+
+Represents: either a is between 3 and 9 and b is not 2, or b is 2 and a
+is less than c.
+*/
+
+/** @help constraints;smarttable Notes
+Each variable may appear in at most one binary condition of each smart
+tuple, and cannot be compared with itself. Smart tuples which no
+assignment satisfies are removed when they are read.
+*/
+
+#ifndef CONSTRAINT_SMARTTABLE_H
+#define CONSTRAINT_SMARTTABLE_H
+
+#include "constraint_checkassign.h"
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+using namespace std;
+
+#include "arrayset.h"
+
+template <typename VarArray>
+struct SmartTable : public AbstractConstraint {
+  virtual string constraintName() {
+    return "smarttable";
+  }
+
+  virtual string fullOutputName() {
+    return ConOutput::printCon(constraintName(), vars, smartTuples);
+  }
+
+  SmartTupleList* smartTuples;
+
+  VarArray vars;
+
+  bool constraintLocked;
+
+  vector<SysInt> tupindices;
+
+  ReversibleInt limit; // In tupindices, indices less than limit are not known
+                       // to be invalid.
+
+  // The variables which do not yet have support for all their values.
+  arrayset ssup;
+
+  vector<arrayset> gacvalues;
+
+  // For each variable position in the current tuple, the values which are
+  // supported by the tuple.
+  vector<vector<DomainInt>> supported;
+  vector<DomainInt> scratch;
+
+  // True for the variables the current tuple has a condition on.
+  vector<char> mentioned;
+
+  SmartTable(const VarArray& _varArray, SmartTupleList* _tuples)
+      : smartTuples(_tuples),
+        vars(_varArray),
+        constraintLocked(false),
+        limit(),
+        supported(_tuples->maxVars()),
+        mentioned(_varArray.size(), 0) {
+    CHECK(smartTuples->maxVar() < (SysInt)vars.size(),
+          "Smart tuples '" + smartTuples->getName() + "' use more variables than smarttable has");
+
+    tupindices.resize(smartTuples->size());
+    for(SysInt i = 0; i < (SysInt)tupindices.size(); i++)
+      tupindices[i] = i;
+
+    ssup.initialise(0, (SysInt)vars.size() - 1);
+
+    gacvalues.resize(vars.size());
+    for(SysInt i = 0; i < (SysInt)vars.size(); i++) {
+      gacvalues[i].initialise(vars[i].initialMin(), vars[i].initialMax());
+    }
+  }
+
+  virtual SysInt dynamicTriggerCount() {
+    return vars.size();
+  }
+
+  void setupTriggers() {
+    for(SysInt i = 0; i < vars.size(); ++i) {
+      moveTriggerInt(vars[i], i, DomainChanged);
+    }
+  }
+
+  virtual void fullPropagate() {
+    setupTriggers();
+    limit = smartTuples->size();
+    do_prop();
+  }
+
+  virtual vector<AnyVarRef> getVars() {
+    vector<AnyVarRef> ret;
+    ret.reserve(vars.size());
+    for(unsigned i = 0; i < vars.size(); ++i)
+      ret.push_back(vars[i]);
+    return ret;
+  }
+
+  virtual bool checkAssignment(DomainInt* v, SysInt vSize) {
+    D_ASSERT(vSize == (SysInt)vars.size());
+    for(SysInt i = 0; i < smartTuples->size(); ++i) {
+      if((*smartTuples)[i].check(v))
+        return true;
+    }
+    return false;
+  }
+
+  virtual bool getSatisfyingAssignment(box<pair<SysInt, DomainInt>>& assignment) {
+    for(SysInt i = 0; i < smartTuples->size(); ++i) {
+      const SmartTuple& tau = (*smartTuples)[i];
+      if(!findSupports(tau))
+        continue;
+
+      // Every value in 'supported' is part of some solution of the tuple, so
+      // choose the first side of each binary condition freely, then find a
+      // value for the second side which goes with it.
+      scratch.clear();
+      for(SysInt j = 0; j < (SysInt)tau.vars.size(); ++j)
+        scratch.push_back(supported[j][0]);
+      for(SysInt j = 0; j < (SysInt)tau.binary.size(); ++j) {
+        const SmartBinaryCondition& b = tau.binary[j];
+        const vector<DomainInt>& second = supported[b.second];
+        for(SysInt k = 0; k < (SysInt)second.size(); ++k) {
+          if(b.holds(scratch[b.first], second[k])) {
+            scratch[b.second] = second[k];
+            break;
+          }
+        }
+        D_ASSERT(b.holds(scratch[b.first], scratch[b.second]));
+      }
+      for(SysInt j = 0; j < (SysInt)tau.vars.size(); ++j)
+        assignment.push_back(make_pair(tau.vars[j].var, scratch[j]));
+      scratch.clear();
+      return true;
+    }
+    return false;
+  }
+
+  virtual AbstractConstraint* reverseConstraint() {
+    return forwardCheckNegation(this);
+  }
+
+  virtual void propagateDynInt(SysInt prop_var, DomainDelta) {
+    if(!constraintLocked) {
+      constraintLocked = true;
+      getQueue().pushSpecialTrigger(this);
+    }
+  }
+
+  virtual void specialUnlock() {
+    constraintLocked = false;
+  }
+
+  virtual void specialCheck() {
+    constraintLocked = false;
+    D_ASSERT(!getState().isFailed());
+    do_prop();
+  }
+
+  // Fills 'out' with the values in the domain of vars[c.var] which satisfy
+  // the unary conditions 'c', in increasing order.
+  void filterDomain(const SmartVarCondition& c, vector<DomainInt>& out) {
+    out.clear();
+    const DomainInt lower = max(c.lower, vars[c.var].min());
+    const DomainInt upper = min(c.upper, vars[c.var].max());
+    if(c.hasSet) {
+      vector<DomainInt>::const_iterator it =
+          std::lower_bound(c.allowed.begin(), c.allowed.end(), lower);
+      for(; it != c.allowed.end() && *it <= upper; ++it) {
+        if(vars[c.var].inDomain(*it))
+          out.push_back(*it);
+      }
+    } else {
+      vector<DomainInt>::const_iterator forbid =
+          std::lower_bound(c.forbidden.begin(), c.forbidden.end(), lower);
+      for(DomainInt val = lower; val <= upper; ++val) {
+        if(forbid != c.forbidden.end() && *forbid == val) {
+          ++forbid;
+          continue;
+        }
+        if(vars[c.var].inDomain(val))
+          out.push_back(val);
+      }
+    }
+  }
+
+  // Removes from 'x' and 'y' all values without support in 'x rel y'.
+  // Both lists are sorted. Returns false if no pair satisfies the relation.
+  bool filterBinary(SmartRelation rel, vector<DomainInt>& x, vector<DomainInt>& y) {
+    switch(rel) {
+    case SMART_EQ:
+      scratch.clear();
+      std::set_intersection(x.begin(), x.end(), y.begin(), y.end(), std::back_inserter(scratch));
+      x = scratch;
+      y = scratch;
+      scratch.clear();
+      return !x.empty();
+    case SMART_NEQ:
+      if(x.size() == 1 && y.size() == 1)
+        return x[0] != y[0];
+      if(y.size() == 1)
+        x.erase(std::remove(x.begin(), x.end(), y[0]), x.end());
+      else if(x.size() == 1)
+        y.erase(std::remove(y.begin(), y.end(), x[0]), y.end());
+      return true;
+    case SMART_LT:
+      if(x.front() >= y.back())
+        return false;
+      x.erase(std::lower_bound(x.begin(), x.end(), y.back()), x.end());
+      y.erase(y.begin(), std::upper_bound(y.begin(), y.end(), x.front()));
+      return true;
+    case SMART_LEQ:
+      if(x.front() > y.back())
+        return false;
+      x.erase(std::upper_bound(x.begin(), x.end(), y.back()), x.end());
+      y.erase(y.begin(), std::lower_bound(y.begin(), y.end(), x.front()));
+      return true;
+    }
+    abort();
+  }
+
+  // Fills 'supported' with the values of each variable of 'tau' which are
+  // in some assignment satisfying 'tau'. As each variable is in at most one
+  // binary condition, this is exact. Returns false if 'tau' is invalid.
+  bool findSupports(const SmartTuple& tau) {
+    for(SysInt j = 0; j < (SysInt)tau.vars.size(); ++j) {
+      filterDomain(tau.vars[j], supported[j]);
+      if(supported[j].empty())
+        return false;
+    }
+    for(SysInt j = 0; j < (SysInt)tau.binary.size(); ++j) {
+      const SmartBinaryCondition& b = tau.binary[j];
+      if(!filterBinary(b.rel, supported[b.first], supported[b.second]))
+        return false;
+    }
+    return true;
+  }
+
+  void addSupports(const SmartTuple& tau) {
+    for(SysInt j = 0; j < (SysInt)tau.vars.size(); ++j) {
+      const SysInt var = tau.vars[j].var;
+      mentioned[var] = 1;
+      if(!ssup.in(var))
+        continue;
+      const vector<DomainInt>& vals = supported[j];
+      for(SysInt k = 0; k < (SysInt)vals.size(); ++k) {
+        if(!gacvalues[var].in(vals[k]))
+          gacvalues[var].unsafe_insert(vals[k]);
+      }
+      if(gacvalues[var].size == vars[var].domSize())
+        ssup.unsafe_remove(var);
+    }
+
+    // Variables the tuple does not mention are supported for every value.
+    for(SysInt j = 0; j < ssup.size; j++) {
+      const SysInt var = ssup.vals[j];
+      if(!mentioned[var]) {
+        ssup.unsafe_remove(var);
+        j--;
+      }
+    }
+    for(SysInt j = 0; j < (SysInt)tau.vars.size(); ++j)
+      mentioned[tau.vars[j].var] = 0;
+  }
+
+  void do_prop() {
+    ssup.fill();
+    for(SysInt t = 0; t < (SysInt)vars.size(); t++)
+      gacvalues[t].clear();
+
+    // Once every value has support the remaining tuples are not checked, so
+    // invalid tuples may stay in the list until a later call.
+    SysInt i = 0;
+    while(i < limit && ssup.size > 0) {
+      const SmartTuple& tau = (*smartTuples)[tupindices[i]];
+      if(!findSupports(tau))
+        removeTuple(i);
+      else {
+        addSupports(tau);
+        i++;
+      }
+    }
+
+    if(limit == 0) {
+      // We found no valid tuples!
+      getState().setFailed(true);
+      return;
+    }
+
+    // Prune the domains.
+    for(SysInt j = 0; j < ssup.size; j++) {
+      SysInt var = ssup.vals[j];
+      if(vars[var].isBound()) {
+        DomainInt new_min = vars[var].max() + 1;
+        for(DomainInt val = vars[var].min(); val <= vars[var].max(); val++) {
+          if(gacvalues[var].in(val)) {
+            new_min = val;
+            break;
+          }
+        }
+        DomainInt new_max = vars[var].min() - 1;
+        for(DomainInt val = vars[var].max(); val >= vars[var].min(); val--) {
+          if(gacvalues[var].in(val)) {
+            new_max = val;
+            break;
+          }
+        }
+
+        vars[var].setMin(new_min);
+        vars[var].setMax(new_max);
+      } else {
+        for(DomainInt val = vars[var].min(); val <= vars[var].max(); val++) {
+          if(!gacvalues[var].in(val)) {
+            vars[var].removeFromDomain(val);
+          }
+        }
+      }
+    }
+  }
+
+  inline void removeTuple(SysInt i) {
+    // Swap to end
+    D_ASSERT(i < limit);
+    SysInt tmp = tupindices[limit - 1];
+    tupindices[limit - 1] = tupindices[i];
+    tupindices[i] = tmp;
+    limit = limit - 1;
+  }
+};
+
+template <typename T>
+AbstractConstraint* BuildCT_SMARTTABLE(const T& t1, ConstraintBlob& b) {
+  return new SmartTable<T>(t1, b.smartTuples);
+}
+
+/* JSON
+  { "type": "constraint",
+    "name": "smarttable",
+    "internal_name": "CT_SMARTTABLE",
+    "args": [ "read_list", "read_smart_tuples" ]
+  }
+  */
+
+#endif
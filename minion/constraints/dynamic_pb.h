@@ -0,0 +1,364 @@
+/*
+ * Minion http://minion.sourceforge.net
+ * Copyright (C) 2006-09
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+/** @help constraints;pbgeq Description
+The constraint
+
+   pbgeq(coeffs, vec, c)
+
+ensures that sum(coeffs[i] * vec[i]) >= c, where vec is a list of 0/1
+variables and coeffs is a list of integer constants (which may be
+negative).
+*/
+
+/** @help constraints;pbgeq Example
+pbgeq([5,3,-2,1], [x,y,z,w], 4)
+*/
+
+/** @help constraints;pbgeq Notes
+This constraint propagates like the pseudo-boolean constraints of SAT
+solvers, by watching a set of literals whose coefficients add up to at least
+c plus the largest coefficient. Only the watched literals are looked at when
+a variable is assigned, so this is usually much faster than weightedsumgeq
+on long rows of 0/1 variables, and on rows with large coefficients.
+
+It enforces the same consistency as weightedsumgeq on 0/1 variables.
+*/
+
+/** @help constraints;pbleq Description
+The constraint
+
+   pbleq(coeffs, vec, c)
+
+ensures that sum(coeffs[i] * vec[i]) <= c, where vec is a list of 0/1
+variables. This is the same as pbgeq with all of the constants negated.
+*/
+
+#ifndef CONSTRAINT_DYNAMIC_PB_H
+#define CONSTRAINT_DYNAMIC_PB_H
+
+#include "constraint_checkassign.h"
+
+/// sum(coeffs[i] * vars[i]) >= bound, for 0/1 variables.
+/// Internally each term is a literal (vars[i] == val) with a positive
+/// coefficient, where negative coefficients are turned into literals on
+/// 0. The terms are sorted by decreasing coefficient.
+template <typename VarArray>
+struct PseudoBooleanConstraint : public AbstractConstraint {
+  virtual string constraintName() {
+    return "pbgeq";
+  }
+
+  typedef typename VarArray::value_type VarRef;
+
+  // The constraint as given, for output and checking.
+  vector<DomainInt> origCoeffs;
+  VarArray origVars;
+  DomainInt origBound;
+
+  CONSTRAINT_ARG_LIST3(origCoeffs, origVars, origBound);
+
+  // The terms, sorted by decreasing coefficient. Term i is the literal
+  // vars[i] == vals[i], which is at position origPos[i] of origVars.
+  VarArray vars;
+  vector<DomainInt> vals;
+  vector<DomainInt> coeffs;
+  vector<SysInt> origPos;
+  DomainInt bound;
+
+  // The watched terms (dynamic trigger i watches term i), and the sum of
+  // their coefficients. These are not backtracked: a watched literal is only
+  // unwatched when the remaining non-false watched literals add up to at
+  // least bound + coeffs[0], which stays true on backtracking. Until then
+  // false literals stay watched.
+  vector<SysInt> watchList;
+  vector<SysInt> watchPos; // position in watchList, or -1
+  DomainInt watchSum;
+  SysInt last;
+
+  // The sum of the coefficients of the watched literals which have been
+  // counted as false on this branch (counted[i] is set, and backtracked).
+  // Literals whose trigger has not yet run may be false but not counted.
+  Reversible<DomainInt> falseWatchSum;
+  char* counted;
+  // True if every non-false literal is watched. Once this is set no literal
+  // is unwatched further down the branch, so falseWatchSum is exact.
+  Reversible<bool> allWatched;
+
+  PseudoBooleanConstraint(const vector<DomainInt>& _coeffs, const VarArray& _vars,
+                          DomainInt _bound)
+      : origCoeffs(_coeffs),
+        origVars(_vars),
+        origBound(_bound),
+        bound(_bound),
+        watchSum(0),
+        last(0),
+        falseWatchSum(0),
+        allWatched(false) {
+    vector<SysInt> order;
+    for(SysInt i = 0; i < (SysInt)origVars.size(); ++i) {
+      if(origCoeffs[i] != 0)
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [this](SysInt a, SysInt b) {
+      return abs(origCoeffs[a]) > abs(origCoeffs[b]);
+    });
+
+    for(SysInt i = 0; i < (SysInt)order.size(); ++i) {
+      DomainInt c = origCoeffs[order[i]];
+      vars.push_back(origVars[order[i]]);
+      origPos.push_back(order[i]);
+      if(c > 0) {
+        vals.push_back(1);
+        coeffs.push_back(c);
+      } else {
+        // c*x == c + (-c)*(x == 0)
+        vals.push_back(0);
+        coeffs.push_back(-c);
+        bound -= c;
+      }
+    }
+
+    // A single literal can never contribute more than the bound.
+    for(SysInt i = 0; i < (SysInt)coeffs.size(); ++i)
+      coeffs[i] = std::min(coeffs[i], std::max(bound, (DomainInt)1));
+
+    watchPos.resize(vars.size(), -1);
+    counted = (char*)getMemory().backTrack().request_bytes(std::max<size_t>(vars.size(), 1));
+  }
+
+  virtual SysInt dynamicTriggerCount() {
+    return vars.size();
+  }
+
+  bool notFalse(SysInt i) {
+    return vars[i].inDomain(vals[i]);
+  }
+
+  void watch(SysInt i) {
+    D_ASSERT(watchPos[i] == -1);
+    watchPos[i] = watchList.size();
+    watchList.push_back(i);
+    watchSum += coeffs[i];
+    moveTriggerInt(vars[i], i, DomainRemoval, vals[i]);
+  }
+
+  // Unwatches a watched literal which is currently false.
+  void unwatchFalse(SysInt i) {
+    D_ASSERT(watchPos[i] != -1 && !notFalse(i));
+    SysInt pos = watchPos[i];
+    watchList[pos] = watchList.back();
+    watchPos[watchList[pos]] = pos;
+    watchList.pop_back();
+    watchPos[i] = -1;
+    watchSum -= coeffs[i];
+    D_ASSERT(counted[i]);
+    falseWatchSum = (DomainInt)falseWatchSum - coeffs[i];
+    releaseTriggerInt(i);
+  }
+
+  // Watches unwatched, non-false terms until the non-false watched terms add
+  // up to 'target', or there are none left. Returns the new sum.
+  DomainInt extendWatches(DomainInt sum, DomainInt target) {
+    const SysInt size = vars.size();
+    const SysInt start = last;
+    for(SysInt loop = 0; loop < size && sum < target; ++loop) {
+      SysInt i = (start + loop) % size;
+      if(watchPos[i] == -1 && notFalse(i)) {
+        watch(i);
+        sum += coeffs[i];
+        last = (i + 1) % size;
+      }
+    }
+    return sum;
+  }
+
+  // Called when every non-false term is watched, and they add up to 'sum'.
+  void propagateSlack(DomainInt sum) {
+    DomainInt slack = sum - bound;
+    if(slack < 0) {
+      getState().setFailed(true);
+      return;
+    }
+    // Any literal which is worth more than the slack must be true.
+    for(SysInt i = 0; i < (SysInt)vars.size() && coeffs[i] > slack; ++i) {
+      if(notFalse(i))
+        vars[i].assign(vals[i]);
+    }
+  }
+
+  virtual void fullPropagate() {
+    for(SysInt i = 0; i < (SysInt)watchList.size(); ++i) {
+      releaseTriggerInt(watchList[i]);
+      watchPos[watchList[i]] = -1;
+    }
+    watchList.clear();
+    watchSum = 0;
+    last = 0;
+    falseWatchSum = 0;
+    allWatched = false;
+    std::fill(counted, counted + vars.size(), 0);
+
+    if(bound <= 0)
+      return;
+
+    if(vars.empty()) {
+      getState().setFailed(true);
+      return;
+    }
+
+    DomainInt target = bound + coeffs[0];
+    DomainInt sum = extendWatches(0, target);
+    if(sum < target) {
+      allWatched = true;
+      propagateSlack(sum);
+    }
+  }
+
+  virtual void propagateDynInt(SysInt trig, DomainDelta) {
+    PROP_INFO_ADDONE(DynPB);
+    if(watchPos[trig] == -1) {
+      releaseTriggerInt(trig);
+      return;
+    }
+    D_ASSERT(!notFalse(trig));
+
+    if(!counted[trig]) {
+      counted[trig] = 1;
+      falseWatchSum = (DomainInt)falseWatchSum + coeffs[trig];
+    }
+    DomainInt target = bound + coeffs[0];
+    DomainInt sum = watchSum - (DomainInt)falseWatchSum;
+
+    // Enough is still watched, so the common case is cheap.
+    if(sum >= target) {
+      unwatchFalse(trig);
+      return;
+    }
+
+    if(allWatched) {
+      propagateSlack(sum);
+      return;
+    }
+
+    sum = 0;
+    for(SysInt j = 0; j < (SysInt)watchList.size(); ++j) {
+      SysInt i = watchList[j];
+      if(notFalse(i))
+        sum += coeffs[i];
+      else
+        counted[i] = 1;
+    }
+    falseWatchSum = watchSum - sum;
+
+    sum = extendWatches(sum, target);
+
+    if(sum < target) {
+      // Keep the false literals watched, so they are watched again once
+      // they become unassigned on backtracking.
+      allWatched = true;
+      propagateSlack(sum);
+      return;
+    }
+
+    // Enough is watched without the false literals, so drop them.
+    for(SysInt j = 0; j < (SysInt)watchList.size(); ++j) {
+      if(!notFalse(watchList[j])) {
+        unwatchFalse(watchList[j]);
+        --j;
+      }
+    }
+  }
+
+  virtual BOOL checkAssignment(DomainInt* v, SysInt vSize) {
+    D_ASSERT(vSize == (SysInt)origVars.size());
+    DomainInt sum = 0;
+    for(SysInt i = 0; i < vSize; ++i)
+      sum += origCoeffs[i] * v[i];
+    return sum >= origBound;
+  }
+
+  virtual vector<AnyVarRef> getVars() {
+    vector<AnyVarRef> v;
+    v.reserve(origVars.size());
+    for(UnsignedSysInt i = 0; i < origVars.size(); ++i)
+      v.push_back(AnyVarRef(origVars[i]));
+    return v;
+  }
+
+  virtual bool getSatisfyingAssignment(box<pair<SysInt, DomainInt>>& assignment) {
+    if(bound <= 0)
+      return true;
+    DomainInt sum = 0;
+    for(SysInt i = 0; i < (SysInt)vars.size(); ++i) {
+      if(notFalse(i)) {
+        assignment.push_back(make_pair(origPos[i], vals[i]));
+        sum += coeffs[i];
+        if(sum >= bound)
+          return true;
+      }
+    }
+    return false;
+  }
+
+  virtual AbstractConstraint* reverseConstraint() {
+    return forwardCheckNegation(this);
+  }
+};
+
+template <typename T>
+inline AbstractConstraint* BuildCT_PBGEQ(const vector<T>& vars, ConstraintBlob& b) {
+  for(SysInt i = 0; i < (SysInt)vars.size(); ++i) {
+    if(vars[i].initialMin() < 0 || vars[i].initialMax() > 1)
+      FAIL_EXIT("pbgeq and pbleq only work on Boolean variables!");
+  }
+  if(b.constants[0].size() != vars.size()) {
+    FAIL_EXIT("In a pbgeq or pbleq constraint, the vector of coefficients must have "
+              "the same length as the vector of variables.");
+  }
+  return new PseudoBooleanConstraint<vector<T>>(b.constants[0], vars, b.constants[1][0]);
+}
+
+/* JSON
+  { "type": "constraint",
+    "name": "pbgeq",
+    "internal_name": "CT_PBGEQ",
+    "args": [ "read_constant_list", "read_list", "read_constant" ]
+  }
+*/
+
+template <typename T>
+inline AbstractConstraint* BuildCT_PBLEQ(const vector<T>& vars, ConstraintBlob& b) {
+  ConstraintBlob negated(b);
+  for(SysInt i = 0; i < (SysInt)negated.constants[0].size(); ++i)
+    negated.constants[0][i] = -negated.constants[0][i];
+  negated.constants[1][0] = -negated.constants[1][0];
+  return BuildCT_PBGEQ(vars, negated);
+}
+
+/* JSON
+  { "type": "constraint",
+    "name": "pbleq",
+    "internal_name": "CT_PBLEQ",
+    "args": [ "read_constant_list", "read_list", "read_constant" ]
+  }
+*/
+
+#endif
@@ -39,8 +39,27 @@ struct BoolSATConstraintDynamic : public AbstractConstraint {
 
   SysInt last;
 
+  // When every variable is a BOOL or its negation, and on average at least
+  // PackedMinPerWord of them share each state word, new supports are found
+  // by testing the packed state of up to 32 variables at once. Otherwise
+  // (for example short clauses over scattered variables) the plain loop is
+  // faster, and literals is NULL.
+  static const SysInt PackedMinPerWord = 4;
+  PackedBoolLiterals* literals;
+  SysInt lastGroup;
+
   BoolSATConstraintDynamic(const VarArray& _varArray) : varArray(_varArray) {
     last = 0;
+    literals = NULL;
+    lastGroup = 0;
+    PackedBoolLiterals candidate;
+    if(makePackedBoolLiterals(varArray, candidate) &&
+       (SysInt)candidate.groups.size() * PackedMinPerWord <= (SysInt)varArray.size())
+      literals = new PackedBoolLiterals(candidate);
+  }
+
+  virtual ~BoolSATConstraintDynamic() {
+    delete literals;
   }
 
   virtual SysInt dynamicTriggerCount() {
@@ -98,6 +117,17 @@ struct BoolSATConstraintDynamic : public AbstractConstraint {
     //  if(varArray[other_propval].isAssignedValue(1))
     //    return;
 
+    if(literals) {
+      SysInt support = literals->findNotFalse(other_propval, lastGroup);
+      if(support == -1) {
+        varArray[other_propval].assign(1);
+        return;
+      }
+      triggerInfo(dt) = support;
+      moveTriggerInt(varArray[support], dt, UpperBound);
+      return;
+    }
+
     bool foundNewSupport = false;
 
     SysInt loop = last;
@@ -97,7 +97,11 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
 
   using FlowConstraint<VarArray, UseIncGraph>::adjlist;
   using FlowConstraint<VarArray, UseIncGraph>::adjlistlength;
-  using FlowConstraint<VarArray, UseIncGraph>::adjlistpos;
+  using FlowConstraint<VarArray, UseIncGraph>::adjlist_in;
+  using FlowConstraint<VarArray, UseIncGraph>::edgeIndex;
+  using FlowConstraint<VarArray, UseIncGraph>::edgeVar;
+  using FlowConstraint<VarArray, UseIncGraph>::edgeVal;
+  using FlowConstraint<VarArray, UseIncGraph>::numEdges;
   using FlowConstraint<VarArray, UseIncGraph>::adjlist_remove;
   using FlowConstraint<VarArray, UseIncGraph>::check_adjlists;
 
@@ -119,6 +123,14 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
   using FlowConstraint<VarArray, UseIncGraph>::hopcroft2;
   using FlowConstraint<VarArray, UseIncGraph>::augpath;
 
+  using FlowConstraint<VarArray, UseIncGraph>::tstack;
+  using FlowConstraint<VarArray, UseIncGraph>::in_tstack;
+  using FlowConstraint<VarArray, UseIncGraph>::visited;
+  using FlowConstraint<VarArray, UseIncGraph>::dfsnum;
+  using FlowConstraint<VarArray, UseIncGraph>::lowlink;
+  using FlowConstraint<VarArray, UseIncGraph>::maxDfs;
+  using FlowConstraint<VarArray, UseIncGraph>::initialize_tarjan_stacks;
+
   GCC(const VarArray& _varArray, const CapArray& _capacity_array, vector<DomainInt> _val_array)
       : FlowConstraint<VarArray, UseIncGraph>(_varArray),
         capacity_array(_capacity_array) //, val_array(_val_array)
@@ -270,10 +282,8 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
             j--; // stay in the same place, dont' skip over the
                  // value which was just swapped into the current position.
           } else {
-            // arranged in blocks for each variable, with numvals triggers in
-            // each block
-            DomainInt mydt = (var * numvals) + (i - domMin);
-            this->moveTriggerInt(varArray[var], mydt, DomainRemoval, i);
+            // one trigger for each edge of the graph
+            this->moveTriggerInt(varArray[var], edgeIndex(var, i), DomainRemoval, i);
           }
         }
       }
@@ -282,7 +292,7 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
 #endif
 
 #ifdef CAPBOUNDSCACHE
-    DomainInt dt = (numvars * numvals);
+    DomainInt dt = numEdges();
     for(SysInt i = 0; i < (SysInt)val_array.size(); i++) {
       // lowerbound first
       for(SysInt j = 0; j < ((SysInt)val_array.size() + numvars); j++) {
@@ -310,7 +320,7 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
   // convert constraint into dynamic.
   SysInt oldDynamicTriggers() {
 #if UseIncGraph && !defined(CAPBOUNDSCACHE)
-    return numvars * numvals; // one for each var-val pair so we know when it is removed.
+    return numEdges(); // one for each var-val pair so we know when it is removed.
 #endif
 
 #if !UseIncGraph && !defined(CAPBOUNDSCACHE)
@@ -318,9 +328,9 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
 #endif
 
 #ifdef CAPBOUNDSCACHE
-    // first numvars*numvals triggers are not used when UseIncGraph is false
+    // first numEdges() triggers are for the incremental graph.
     // one block of numvars+val_Array.size() for each bound.
-    return numvars * numvals + 2 * val_array.size() * (numvars + val_array.size());
+    return numEdges() + 2 * val_array.size() * (numvars + val_array.size());
 #endif
   }
 
@@ -360,18 +370,17 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
 #endif
 
 #ifdef CAPBOUNDSCACHE
-    if(trig < dtstart + (numvars * numvals))
+    if(trig < dtstart + numEdges())
 #endif
     {
       // which var/val is this trigger attached to?
       D_ASSERT(UseIncGraph);
 #if UseIncGraph
-      SysInt diff = trig - dtstart;
-      SysInt var = diff / numvals;
-      SysInt validx = diff % numvals;
+      SysInt var = edgeVar[trig - dtstart];
+      SysInt validx = edgeVal(trig - dtstart) - domMin;
 
-      if(adjlistpos[validx + numvars][var] < adjlistlength[validx + numvars]) {
-        adjlist_remove(var, validx + domMin);      // validx, adjlistpos[validx][var]);
+      if(adjlist_in(var, validx + domMin)) {
+        adjlist_remove(var, validx + domMin);
         if(varvalmatching[var] == validx + domMin) // remove invalid value in the matching.
         {
           varvalmatching[var] = domMin - 1;
@@ -596,7 +605,7 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
     }
 
     if(run_propagator) {
-      tarjan_recursive(0, upper, lower, varvalmatching, usage);
+      tarjan(0, upper, lower, varvalmatching, usage);
     } else {
       GCCPRINT("Saved a call with InternalDT.");
     }
@@ -662,7 +671,7 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
     // use augpath temporarily for the upper bound.
     augpath.clear();
     augpath.resize(numvals, numvars);
-    tarjan_recursive(0, augpath, lower, lbcmatching, lbcusage);
+    tarjan(0, augpath, lower, lbcmatching, lbcusage);
 
     // Now ubc
 
@@ -675,7 +684,7 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
     // borrow augpath for the lower bounds.
     augpath.clear();
     augpath.resize(numvals, 0);
-    tarjan_recursive(0, upper, augpath, varvalmatching, usage);
+    tarjan(0, upper, augpath, varvalmatching, usage);
 
     prop_capacity();
   }
@@ -816,7 +825,7 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
 
         if(run_propagator) {
           // cout << 1 << endl;
-          tarjan_recursive(sccindexStart, upper, lower, varvalmatching, usage);
+          tarjan(sccindexStart, upper, lower, varvalmatching, usage);
         } else {
           // cout << "Saved a call to tarjan's with dc/wl" << endl;
         }
@@ -1344,42 +1353,41 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
   //
   // Tarjan's algorithm
 
-  vector<SysInt> tstack;
-  smallset_nolist in_tstack;
-  smallset_nolist visited;
-  vector<SysInt> dfsnum;
-  vector<SysInt> lowlink;
-
-  vector<SysInt> curnodestack;
-
   bool sccSplit;
 
   SysInt sccindex;
 
-  SysInt maxDfs;
-
   SysInt varcount, valcount;
   // SysInt localmin,localmax;
 
+  // The flow and matching Tarjan's is run on, set by tarjan().
+  vector<SysInt>* tarjanUpper;
+  vector<SysInt>* tarjanLower;
+  vector<SysInt>* tarjanMatching;
+  vector<SysInt>* tarjanUsage;
+
+#if InternalDT
+  vector<SysInt> lowlinkvar; // Where the lowlink of each value came from.
+#endif
+
   void initialize_tarjan() {
-    SysInt numnodes = numvars + numvals + 1; // One sink node.
-    tstack.reserve(numnodes);
-    in_tstack.reserve(numnodes);
-    visited.reserve(numnodes);
-    maxDfs = 1;
+    initialize_tarjan_stacks();
     sccSplit = false;
-    dfsnum.resize(numnodes);
-    lowlink.resize(numnodes);
-
-    // iterationstack.resize(numnodes);
-    curnodestack.reserve(numnodes);
+#if InternalDT
+    lowlinkvar.resize(numvars + numvals + 1, -1);
+#endif
 
     // valinlocalmatching.reserve(numvals);
     // varinlocalmatching.reserve(numvars);
   }
 
-  void tarjan_recursive(SysInt sccindexStart, vector<SysInt>& upper, vector<SysInt>& lower,
-                        vector<SysInt>& matching, vector<SysInt>& usage) {
+  void tarjan(SysInt sccindexStart, vector<SysInt>& upper, vector<SysInt>& lower,
+              vector<SysInt>& matching, vector<SysInt>& usage) {
+    tarjanUpper = &upper;
+    tarjanLower = &lower;
+    tarjanMatching = &matching;
+    tarjanUsage = &usage;
+
     tstack.clear();
     in_tstack.clear();
 
@@ -1404,7 +1412,7 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
         GCCPRINT("(Re)starting tarjan's algorithm, at node:" << curnode);
         varcount = 0;
         valcount = 0;
-        visit(curnode, true, upper, lower, matching, usage);
+        this->tarjan_dfs(this, curnode);
         GCCPRINT("Returned from tarjan's algorithm.");
       }
     }
@@ -1417,7 +1425,7 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
         GCCPRINT("(Re)starting tarjan's algorithm, at node:" << curnode);
         varcount = 0;
         valcount = 0;
-        visit(curnode, true, upper, lower, matching, usage);
+        this->tarjan_dfs(this, curnode);
         GCCPRINT("Returned from tarjan's algorithm.");
       }
     }
@@ -1454,172 +1462,99 @@ struct GCC : public FlowConstraint<VarArray, UseIncGraph> {
 #endif
   }
 
-  void visit(SysInt curnode, bool toplevel, vector<SysInt>& upper, vector<SysInt>& lower,
-             vector<SysInt>& matching, vector<SysInt>& usage) {
-    // toplevel is true iff this is the top level of the recursion.
-    tstack.push_back(curnode);
-    in_tstack.insert(curnode);
-    dfsnum[curnode] = maxDfs;
-    lowlink[curnode] = maxDfs;
-    maxDfs++;
-    visited.insert(curnode);
+  // The residual graph, walked by tarjan_dfs.
+
+  void tarjan_enter(SysInt curnode, SysInt parent) {
     GCCPRINT("Visiting node: " << curnode);
+    if(curnode < numvars) {
+      D_ASSERT(find(vars_in_scc.begin(), vars_in_scc.end(), curnode) != vars_in_scc.end());
+      varcount++;
+#if InternalDT
+      if(parent != -1 && parent != numvars + numvals) {
+        GCCPRINT("Adding DT for var " << curnode << " val " << parent - numvars + domMin);
+        idt.addwatch(curnode, parent - numvars + domMin);
+      }
+#endif
+    } else if(curnode < numvars + numvals) {
+      valcount++;
+#if InternalDT
+      lowlinkvar[curnode] = -1;
+#endif
+    }
+  }
 
-    if(curnode == numvars + numvals) {
-      // cout << "Visiting sink node." <<endl;
-      // It's the sink so it links to all spare values.
-      /*
-      for(SysInt i=0; i<spareValues.size(); ++i)
-      {
-          SysInt newnode=spareValues[i];
-          //cout << "About to visit spare value: " << newnode-numvars+domMin
-      <<endl;
-          if(!visited.in(newnode))
-          {
-              visit(newnode);
-              if(lowlink[newnode]<lowlink[curnode])
-              {
-                  lowlink[curnode]=lowlink[newnode];
-              }
-          }
-          else
-          {
-              // Already visited newnode
-              if(in_tstack.in(newnode) && dfsnum[newnode]<lowlink[curnode])
-              {
-                  lowlink[curnode]=dfsnum[newnode];
-              }
-          }
-      }*/
+  SysInt tarjan_next(SysInt curnode, SysInt& pos) {
+    vector<SysInt>& matching = *tarjanMatching;
+    vector<SysInt>& usage = *tarjanUsage;
 
+    if(curnode == numvars + numvals) {
       // GCC mod:
       // link to any value which is below its upper cap.
-      GCCPRINT("usage:" << usage);
-      GCCPRINT("upper:" << upper);
-
-      for(SysInt j = 0; j < (SysInt)valsInSCC.size(); j++) {
-        SysInt i = valsInSCC[j];
-        SysInt newnode = i + numvars - domMin;
+      vector<SysInt>& upper = *tarjanUpper;
+      while(pos < (SysInt)valsInSCC.size()) {
+        SysInt i = valsInSCC[pos++];
         if(usage[i - domMin] < upper[i - domMin]) {
           GCCPRINT("val " << i << "below upper cap.");
-          if(!visited.in(newnode)) {
-            visit(newnode, false, upper, lower, matching, usage);
-            if(lowlink[newnode] < lowlink[curnode]) {
-              lowlink[curnode] = lowlink[newnode];
-            }
-          } else {
-            // Already visited newnode
-            if(in_tstack.in(newnode) && dfsnum[newnode] < lowlink[curnode]) {
-              lowlink[curnode] = dfsnum[newnode];
-            }
-          }
+          return i + numvars - domMin;
         }
       }
-    } else if(curnode < numvars) {
-      D_ASSERT(find(vars_in_scc.begin(), vars_in_scc.end(), curnode) != vars_in_scc.end());
-      varcount++;
-      SysInt newnode = matching[curnode] - domMin + numvars;
-      // D_ASSERT(varArray[curnode].inDomain(matching[curnode]));
-      D_ASSERT(adjlistpos[curnode][matching[curnode] - domMin] < adjlistlength[curnode]);
+      return -1;
+    }
 
-      if(!visited.in(newnode)) {
-        visit(newnode, false, upper, lower, matching, usage);
-        if(lowlink[newnode] < lowlink[curnode]) {
-          lowlink[curnode] = lowlink[newnode];
-        }
-      } else {
-        // Already visited newnode
-        if(in_tstack.in(newnode) && dfsnum[newnode] < lowlink[curnode]) {
-          lowlink[curnode] = dfsnum[newnode]; // Why dfsnum not lowlink?
-        }
-      }
-    } else {
-      // curnode is a value
-      // This is the only case where watches are set.
-      // cout << "Visiting node val: "<< curnode+domMin-numvars <<endl;
-      valcount++;
-      D_ASSERT(curnode >= numvars && curnode < (numvars + numvals));
-#ifndef NO_DEBUG
-/*
-bool found=false;
-for(SysInt i=0; i<vars_in_scc.size(); i++)
-{
-    if(varArray[vars_in_scc[i]].inDomain(curnode+domMin-numvars))
-    {
-        found=true;
+    if(curnode < numvars) {
+      // A variable links to the value it is matched to.
+      if(pos++ > 0)
+        return -1;
+      // D_ASSERT(varArray[curnode].inDomain(matching[curnode]));
+      D_ASSERT(adjlist_in(curnode, matching[curnode]));
+      return matching[curnode] - domMin + numvars;
     }
-}*/
-// D_ASSERT(found);  // it is safe to take out this test. But how did we get to
-// this value?
-#endif
 
-      SysInt lowlinkvar = -1;
+    // curnode is a value. It links to the variables it is not matched to.
+    SysInt val = curnode - numvars + domMin;
 #if !UseIncGraph
-      for(SysInt i = 0; i < (SysInt)vars_in_scc.size(); i++) {
-        SysInt newnode = vars_in_scc[i];
+    const SysInt listsize = vars_in_scc.size();
 #else
-      for(SysInt i = 0; i < adjlistlength[curnode]; i++) {
-        SysInt newnode = adjlist[curnode][i];
+    const SysInt listsize = adjlistlength[curnode];
 #endif
-        if(matching[newnode] != curnode - numvars + domMin) // if the value is not in the matching.
-        {
+    while(pos < listsize) {
 #if !UseIncGraph
-          if(varArray[newnode].inDomain(curnode + domMin - numvars))
+      SysInt newnode = vars_in_scc[pos++];
+      if(matching[newnode] != val && varArray[newnode].inDomain(val))
+        return newnode;
+#else
+      SysInt newnode = adjlist[curnode][pos++];
+      if(matching[newnode] != val)
+        return newnode;
 #endif
-          {
-            // newnode=varvalmatching[newnode]-domMin+numvars;  // Changed here
-            // for merge nodes
-            if(!visited.in(newnode)) {
+    }
+
+    // Finally link to the sink if the value is above its lower cap.
+    if(pos++ == listsize && usage[curnode - numvars] > (*tarjanLower)[curnode - numvars])
+      return numvars + numvals;
+    return -1;
+  }
+
+  void tarjan_lowered(SysInt curnode, SysInt from) {
 #if InternalDT
-              GCCPRINT("Adding DT for var " << newnode << " val " << curnode - numvars + domMin);
-              idt.addwatch(newnode, curnode - numvars + domMin);
+    // Remember a back edge to a variable, so a watch can be placed on it.
+    if(curnode >= numvars && curnode < numvars + numvals)
+      lowlinkvar[curnode] = (from != -1 && from < numvars) ? from : -1;
 #endif
-              visit(newnode, false, upper, lower, matching, usage);
-              if(lowlink[newnode] < lowlink[curnode]) {
-                lowlink[curnode] = lowlink[newnode];
-                lowlinkvar = -1; // Would be placing a watch where there already is one.
-              }
-            } else {
-              // Already visited newnode
-              if(in_tstack.in(newnode) && dfsnum[newnode] < lowlink[curnode]) {
-                lowlink[curnode] = dfsnum[newnode];
-                lowlinkvar = newnode;
-              }
-            }
-          }
-        }
-      }
-      (void)lowlinkvar;                                          // to block warning
-      if(true                                                    // include_sink
-         && usage[curnode - numvars] > lower[curnode - numvars]) // adaptation for
-                                                                 // GCC instead of
-                                                                 // the following
-                                                                 // comment.
-      // valinlocalmatching.in(curnode-numvars))
-      {
-        SysInt newnode = numvars + numvals;
-        if(!visited.in(newnode)) {
-          visit(newnode, false, upper, lower, matching, usage);
-          if(lowlink[newnode] < lowlink[curnode]) {
-            lowlink[curnode] = lowlink[newnode];
-            lowlinkvar = -1;
-          }
-        } else {
-          // Already visited newnode
-          if(in_tstack.in(newnode) && dfsnum[newnode] < lowlink[curnode]) {
-            lowlink[curnode] = dfsnum[newnode];
-            lowlinkvar = -1;
-          }
-        }
-      }
+  }
+
+  void tarjan_finish(SysInt curnode, bool toplevel) {
+    vector<SysInt>& matching = *tarjanMatching;
+
 // Where did the low link value come from? insert that edge into watches.
 #if InternalDT
-      if(lowlinkvar != -1) {
-        GCCPRINT("Adding DT for var " << lowlinkvar << " val " << curnode - numvars + domMin);
-        idt.addwatch(lowlinkvar, curnode - numvars + domMin);
-      }
-#endif
+    if(curnode >= numvars && curnode < numvars + numvals && lowlinkvar[curnode] != -1) {
+      GCCPRINT("Adding DT for var " << lowlinkvar[curnode] << " val "
+                                    << curnode - numvars + domMin);
+      idt.addwatch(lowlinkvar[curnode], curnode - numvars + domMin);
     }
+#endif
+
 
     // cout << "On way back up, curnode:" << curnode<< ",
     // lowlink:"<<lowlink[curnode]<< ", dfsnum:"<<dfsnum[curnode]<<endl;
@@ -2059,7 +1994,7 @@ for(SysInt i=0; i<vars_in_scc.size(); i++)
 
 #ifdef CAPBOUNDSCACHE
     boundsupported[(forbiddenval - domMin) * 2] = usage[forbiddenval - domMin];
-    DomainInt dt = (numvars * numvals); // skip over the first block of triggers
+    DomainInt dt = numEdges(); // skip over the first block of triggers
     dt += valToCapIndex[forbiddenval - domMin] * (val_array.size() + numvars) *
           2; // move to the area for the value.
     // dt+=(val_array.size()+numvars);  // move to upper bound area
@@ -2197,7 +2132,7 @@ for(SysInt i=0; i<vars_in_scc.size(); i++)
 // usage=usagebac;
 #ifdef CAPBOUNDSCACHE
     boundsupported[(value - domMin) * 2 + 1] = usage[startvalindex];
-    DomainInt dt += (numvars * numvals); // skip over the first block of triggers
+    DomainInt dt += numEdges(); // skip over the first block of triggers
     dt += valToCapIndex[value - domMin] * (val_array.size() + numvars) *
           2;                            // move to the area for the value.
     dt += (val_array.size() + numvars); // move to upper bound area
@@ -53,10 +53,31 @@ struct LessEqualSumConstraint : public AbstractConstraint {
 
   VarArray varArray;
   VarSum varSum;
-  DomainInt max_looseness;
+  /// An upper bound on max() - min() of every variable in varArray. It only
+  /// goes down during search, so is restored on backtracking.
+  Reversible<DomainInt> max_looseness;
   Reversible<DomainInt> varArrayMinSum;
+
+  /// The positions of varArray, ordered by decreasing initial span
+  /// (initialMax() - initialMin()), and those spans. A variable's span can
+  /// never be larger than its initial span, so when pruning to a looseness
+  /// only a prefix of this order has to be visited.
+  vector<SysInt> spanOrder;
+  vector<DomainInt> initialSpans;
+
   LessEqualSumConstraint(const VarArray& _varArray, VarSum _varSum)
-      : varArray(_varArray), varSum(_varSum), varArrayMinSum() {
+      : varArray(_varArray), varSum(_varSum), max_looseness(), varArrayMinSum() {
+    spanOrder.resize(varArray.size());
+    for(SysInt i = 0; i < (SysInt)varArray.size(); ++i)
+      spanOrder[i] = i;
+    std::stable_sort(spanOrder.begin(), spanOrder.end(), [this](SysInt a, SysInt b) {
+      return varArray[a].initialMax() - varArray[a].initialMin() >
+             varArray[b].initialMax() - varArray[b].initialMin();
+    });
+    initialSpans.resize(varArray.size());
+    for(SysInt i = 0; i < (SysInt)varArray.size(); ++i)
+      initialSpans[i] = varArray[spanOrder[i]].initialMax() - varArray[spanOrder[i]].initialMin();
+
     BigInt accumulator = 0;
     for(SysInt i = 0; i < (SysInt)varArray.size(); i++) {
       accumulator += checked_cast<SysInt>(
@@ -117,9 +138,15 @@ struct LessEqualSumConstraint : public AbstractConstraint {
       return;
     }
 
-    if(looseness < max_looseness) {
-      for(typename VarArray::iterator it = varArray.begin(); it != varArray.end(); ++it)
-        it->setMax(it->min() + looseness);
+    // Once every variable has been pruned to this looseness, no span can be
+    // larger than it further down this branch.
+    if(looseness < (DomainInt)max_looseness) {
+      const SysInt size = varArray.size();
+      for(SysInt i = 0; i < size && initialSpans[i] > looseness; ++i) {
+        VarRef& v = varArray[spanOrder[i]];
+        v.setMax(v.min() + looseness);
+      }
+      max_looseness = looseness;
     }
   }
 
@@ -88,6 +88,8 @@ PROP_EVENT(DynSumSat)
 PROP_EVENT(Dyn3SAT)
 PROP_EVENT(Dyn2SAT)
 PROP_EVENT(DynLitWatch)
+PROP_EVENT(DynPB)
+PROP_EVENT(BoundsAlldiff)
 PROP_EVENT(DynElement)
 PROP_EVENT(DynVecNeq)
 PROP_EVENT(DynGACTable)
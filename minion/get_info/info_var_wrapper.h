@@ -151,6 +151,25 @@ struct InfoRefType {
     data.removeFromDomain(b);
   }
 
+  void removeValues(const vector<DomainInt>& vals) {
+    VAR_INFO_ADDONE(VAR_TYPE, RemoveFromDomain);
+    data.removeValues(vals);
+  }
+
+  void intersectWith(const DomainBitset& keep) {
+    VAR_INFO_ADDONE(VAR_TYPE, RemoveFromDomain);
+    data.intersectWith(keep);
+  }
+
+  template <typename F>
+  void forEachValue(F f) const {
+    data.forEachValue(f);
+  }
+
+  DomainBitset domainAsBitset() const {
+    return data.domainAsBitset();
+  }
+
   vector<AbstractConstraint*>* getConstraints() {
     VAR_INFO_ADDONE(VAR_TYPE, getConstraints);
     return data.getConstraints();
@@ -9,6 +9,8 @@
 
 #include "MILtools/sym_output.h"
 
+#include "MILtools/sym_detect.h"
+
 void infoDumps(CSPInstance& instance) {
 
   if(getOptions().graph) {
@@ -25,6 +27,7 @@ void infoDumps(CSPInstance& instance) {
     // Do the minimal amount of setting up to create the constraint objects
     getState().setTupleListContainer(instance.tupleListContainer);
     getState().setShortTupleListContainer(instance.shortTupleListContainer);
+    getState().setSmartTupleListContainer(instance.smartTupleListContainer);
 
     BuildCon::buildVariables(instance.vars);
 
@@ -45,4 +48,66 @@ void infoDumps(CSPInstance& instance) {
     cout << printer.getInstance();
     exit(0);
   }
-}
\ No newline at end of file
+}
+
+// Returns generators of the symmetries of the variables, each as a
+// permutation of the positions in instance.symOrder.
+static vector<vector<SysInt>> findSymmetryGenerators(CSPInstance& instance) {
+  GraphBuilder graph(instance);
+  // Symmetries must leave the objective where it is.
+  for(SysInt i = 0; i < (SysInt)instance.optimiseVariables.size(); ++i) {
+    string v = graph.g.new_vertex("OBJECTIVE_" + tostring(i));
+    graph.add_edge(v, instance.optimiseVariables[i]);
+  }
+
+  SysInt varCount;
+  vector<set<SysInt>> edges;
+  vector<set<SysInt>> partitions;
+  std::tie(varCount, edges, partitions) = graph.g.build_graph_info(instance, false);
+
+  AutomorphismFinder finder(edges, partitions);
+  vector<vector<SysInt>> automorphisms = finder.findGenerators();
+
+  // Vertex i + 1 is symOrder[i].
+  vector<vector<SysInt>> generators;
+  for(SysInt g = 0; g < (SysInt)automorphisms.size(); ++g) {
+    vector<SysInt> perm(varCount);
+    bool moves = false;
+    for(SysInt i = 0; i < varCount; ++i) {
+      perm[i] = automorphisms[g][i + 1] - 1;
+      D_ASSERT(perm[i] >= 0 && perm[i] < varCount);
+      moves |= (perm[i] != i);
+    }
+    if(moves)
+      generators.push_back(perm);
+  }
+  return generators;
+}
+
+void addSymmetryBreaking(CSPInstance& instance) {
+  if(instance.vars.getAllVars().empty())
+    return;
+
+  vector<vector<SysInt>> generators = findSymmetryGenerators(instance);
+  getOptions().printLine("Symmetry generators found: " + tostring(generators.size()));
+  getTableOut().set("SymmetryGenerators", tostring(generators.size()));
+
+  if(getOptions().symmetryBreak == SB_Dynamic) {
+    instance.symmetryGenerators = generators;
+    return;
+  }
+
+  // Post symOrder <=lex gen(symOrder), leaving out the positions a
+  // generator fixes, which always compare equal.
+  const vector<Var>& vars = instance.symOrder;
+  for(const auto& gen : generators) {
+    vector<vector<Var>> lex(2);
+    for(SysInt i = 0; i < (SysInt)gen.size(); ++i) {
+      if(gen[i] != i) {
+        lex[0].push_back(vars[i]);
+        lex[1].push_back(vars[gen[i]]);
+      }
+    }
+    instance.add_constraint(ConstraintBlob(get_constraint(CT_LEXLEQ), lex));
+  }
+}
@@ -4,4 +4,9 @@
 
 #include "inputfile_parse/inputfile_parse.h"
 
-void infoDumps(CSPInstance& instance);
\ No newline at end of file
+void infoDumps(CSPInstance& instance);
+
+/// Finds symmetries of the variables of instance. With -symmetry-lex adds a
+/// lexleq constraint to break each generator found, and with
+/// -symmetry-dynamic keeps the generators for search to use.
+void addSymmetryBreaking(CSPInstance& instance);
@@ -57,6 +57,7 @@ enum ReadTypes {
   read_constant_list,
   read_tuples,
   read_short_tuples,
+  read_smart_tuples,
   read_constraint,
   read_constraint_list,
   read_nothing
@@ -133,6 +134,9 @@ struct ConstraintBlob {
   /// Pointer to a list of short tuples. Only used in Short Table constraints.
   ShortTupleList* shortTuples;
 
+  /// Pointer to a list of smart tuples. Only used in Smart Table constraints.
+  SmartTupleList* smartTuples;
+
   TupleList* tuples2;
 
   /// A vector of signs. Only used for SAT clause "or" constraint.
@@ -154,13 +158,15 @@ struct ConstraintBlob {
     assert(0);
   }
 
-  ConstraintBlob(ConstraintDef* _con) : constraint(_con), tuples(0), tuples2(0) {}
+  ConstraintBlob(ConstraintDef* _con)
+      : constraint(_con), tuples(0), smartTuples(0), tuples2(0) {}
 
   ConstraintBlob(ConstraintDef* _con, const vector<vector<Var>>& _vars)
-      : constraint(_con), vars(_vars), tuples(0), shortTuples(0), tuples2(0) {}
+      : constraint(_con), vars(_vars), tuples(0), shortTuples(0), smartTuples(0), tuples2(0) {}
 
   /// A helper constructor for when only a SingleVar is passed.
-  ConstraintBlob(ConstraintDef* _con, vector<Var>& _var) : constraint(_con), tuples(0), tuples2(0) {
+  ConstraintBlob(ConstraintDef* _con, vector<Var>& _var)
+      : constraint(_con), tuples(0), smartTuples(0), tuples2(0) {
     vars.push_back(_var);
   }
 
@@ -469,12 +475,17 @@ struct CSPInstance {
   list<ConstraintBlob> constraints;
   shared_ptr<TupleListContainer> tupleListContainer;
   shared_ptr<ShortTupleListContainer> shortTupleListContainer;
+  shared_ptr<SmartTupleListContainer> smartTupleListContainer;
 
   vector<SearchOrder> searchOrder;
   vector<Var> permutation;
   vector<Var> symOrder;
   vector<Var> preprocess_vars;
 
+  /// Generators of the symmetries of the variables, as permutations of the
+  /// positions in symOrder. Only filled in for -symmetry-dynamic.
+  vector<vector<SysInt>> symmetryGenerators;
+
   /// Only used for gadgets.
   vector<Var> constructionSite;
 
@@ -493,12 +504,16 @@ struct CSPInstance {
   map<string, ShortTupleList*> shorttable_symboltable;
   map<ShortTupleList*, string> shorttable_nametable;
 
+  map<string, SmartTupleList*> smarttable_symboltable;
+  map<SmartTupleList*, string> smarttable_nametable;
+
   /// We make these shared_ptrs so they automatically clear up after themselves.
   map<string, shared_ptr<CSPInstance>> gadgetMap;
 
   CSPInstance()
       : tupleListContainer(new TupleListContainer),
         shortTupleListContainer(new ShortTupleListContainer),
+        smartTupleListContainer(new SmartTupleListContainer),
         is_optimisation_problem(false) {}
 
 private:
@@ -547,6 +562,16 @@ public:
     tuplelist->setName(name);
   }
 
+  void addSmartTableSymbol(string name, SmartTupleList* tuplelist) {
+    if(smarttable_symboltable.count(name) != 0)
+      throw parse_exception("SmartTuplename '" + name + "' already in use");
+    if(smarttable_nametable.count(tuplelist) != 0)
+      throw parse_exception("Named tuplelist double registered!");
+    smarttable_symboltable[name] = tuplelist;
+    smarttable_nametable[tuplelist] = name;
+    tuplelist->setName(name);
+  }
+
   TupleList* getTableSymbol(string name) const {
     map<string, TupleList*>::const_iterator it = table_symboltable.find(name);
     if(it == table_symboltable.end())
@@ -575,6 +600,13 @@ public:
     return it->second;
   }
 
+  SmartTupleList* getSmartTableSymbol(string name) const {
+    map<string, SmartTupleList*>::const_iterator it = smarttable_symboltable.find(name);
+    if(it == smarttable_symboltable.end())
+      throw parse_exception("Undefined smarttuplelist: '" + name + "'");
+    return it->second;
+  }
+
   void addGadgetSymbol(string name, shared_ptr<CSPInstance> gadget) {
     if(gadgetMap.count(name) != 0)
       throw parse_exception("Gadget name " + name + " already in use.");
@@ -98,6 +98,12 @@ struct ConcreteFileReader {
     return this->read_int();
   }
 
+  /// Reads 'count' numbers straight into 'out'.
+  void readNums(DomainInt* out, size_t count) {
+    if(!infile.getNums(out, count))
+      throw parse_exception("Problem parsing number");
+  }
+
   char simplepeekChar() {
     char peek = infile.peek();
     while(isspace(peek)) {
@@ -200,6 +206,7 @@ class MinionThreeInputReader {
   void readObjective(FileReader* infile);
   void readShortTuples(FileReader* infile);
   void readTuples(FileReader* infile);
+  void readMDDs(FileReader* infile);
   void readMatrices(FileReader* infile);
   void readValOrder(FileReader* infile);
   void readVarOrder(FileReader* infile);
@@ -208,6 +215,10 @@ class MinionThreeInputReader {
   void readSearch(FileReader* infile);
   vector<pair<SysInt, DomainInt>> readShortTuple(FileReader*);
   ShortTupleList* readConstraintShortTupleList(FileReader*);
+  void readSmartTuples(FileReader* infile);
+  SmartTuple readSmartTuple(FileReader*);
+  vector<DomainInt> readSmartSet(FileReader*);
+  SmartTupleList* readConstraintSmartTupleList(FileReader*);
   vector<vector<Var>> read2DMatrix(FileReader* infile);
   vector<vector<Var>> read2DMatrixVariable(FileReader* infile);
   void readAliasMatrix(FileReader* infile, const vector<DomainInt>& max_indices,
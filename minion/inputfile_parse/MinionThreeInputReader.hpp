@@ -103,6 +103,75 @@ short tuples.
 
 
 
+/** @help input;mdd Example
+**MDD**
+mycon 3 4
+[(0,1),(1,2)]
+[(0,3),(1,3)]
+[(1,3)]
+[(0,t),(2,t)]
+
+An MDD section gives tables directly as multi-valued decision
+diagrams, for use with the mddc constraint. Each MDD is given as:
+
+<name> <arity> <num_nodes> <node>+
+
+where each node is a list of pairs (value,child), giving the node to
+move to when the variable at that layer takes that value. Node 0 is the
+top node, and nodes are numbered from 0 in the order they are
+given. A child of 't' accepts the tuple, leaving any remaining
+variables unconstrained. Values with no link are not allowed.
+
+The MDD 'mycon' above represents the same constraint as:
+
+**TUPLELIST**
+mycon 6 3
+0 0 0
+0 0 2
+0 1 0
+0 1 2
+1 1 0
+1 1 2
+
+MDDs are reduced (equal subgraphs are merged) as they are read, and
+are stored in memory proportional to the size of the MDD rather than
+the number of tuples it represents. MDDs share names with tuplelists,
+and can be used as 'mddc([x,y,z], mycon)'.
+*/
+
+
+
+
+
+
+
+/** @help input;smarttuplelist Example
+**SMARTTUPLELIST**
+mycon 2
+[(x0 in {1,3..4}), (x1 != 2)]
+[(x0 < x2), (x1 = 2)]
+
+A smart tuplelist section gives tables as lists of smart tuples, for use
+with the smarttable constraint. Each smart tuplelist is given as:
+
+<name> <num_tuples> <smarttuple>+
+
+where each smart tuple is a list of conditions. A condition compares the
+variable at some index (written x0, x1, ...) with a constant, with
+another variable, or with a set of values and ranges:
+
+(x0 = 3) (x0 != 3) (x0 < 3) (x0 <= 3) (x0 > 3) (x0 >= 3)
+(x0 < x2) (x0 in {1,3..4}) (x0 notin {2,5})
+
+A smart tuple allows every assignment which satisfies all its
+conditions. Variables which are not mentioned may take any value. Each
+variable may be in at most one condition comparing two variables.
+*/
+
+
+
+
+
 /** @help input;example Example
 Below is a complete minion input file with commentary, as an example.
 
@@ -341,6 +410,10 @@ void MinionThreeInputReader<FileReader>::read(FileReader* infile) {
       readTuples(infile);
     else if(s == "**SHORTTUPLELIST**")
       readShortTuples(infile);
+    else if(s == "**MDD**")
+      readMDDs(infile);
+    else if(s == "**SMARTTUPLELIST**")
+      readSmartTuples(infile);
     else if(s == "**CONSTRAINTS**") {
       while(infile->peekChar() != '*')
         instance->constraints.push_back(readConstraint(infile, false));
@@ -409,7 +482,9 @@ ConstraintBlob MinionThreeInputReader<FileReader>::readConstraint(FileReader* in
   switch(constraint->type) {
   default:
     if(constraint->numberOfParams == 2 &&
-       (constraint->read_types[1] == read_tuples || constraint->read_types[1] == read_short_tuples))
+       (constraint->read_types[1] == read_tuples ||
+        constraint->read_types[1] == read_short_tuples ||
+        constraint->read_types[1] == read_smart_tuples))
       return readConstraintTable(infile, constraint);
     else
       return readGeneralConstraint(infile, constraint);
@@ -431,12 +506,20 @@ ConstraintBlob MinionThreeInputReader<FileReader>::readConstraintTable(FileReade
     con.tuples = readConstraintTupleList(infile);
   else if(def->read_types[1] == read_short_tuples)
     con.shortTuples = readConstraintShortTupleList(infile);
+  else if(def->read_types[1] == read_smart_tuples)
+    con.smartTuples = readConstraintSmartTupleList(infile);
   else
     assert(0);
 
   infile->checkSym(')');
 
-  if(def->read_types[1] == read_tuples && con.tuples->size() == 0) {
+  if(def->read_types[1] == read_tuples && con.tuples->isMDDOnly()) {
+    if(def->name != "mddc")
+      throw parse_exception("The MDD '" + con.tuples->getName() +
+                            "' can only be used by mddc, not " + def->name);
+    if(con.tuples->getMDD()->empty())
+      return ConstraintBlob(get_constraint(CT_FALSE));
+  } else if(def->read_types[1] == read_tuples && con.tuples->size() == 0) {
     return ConstraintBlob(get_constraint(CT_FALSE));
   }
 
@@ -444,6 +527,10 @@ ConstraintBlob MinionThreeInputReader<FileReader>::readConstraintTable(FileReade
     return ConstraintBlob(get_constraint(CT_FALSE));
   }
 
+  if(def->read_types[1] == read_smart_tuples && con.smartTuples->size() == 0) {
+    return ConstraintBlob(get_constraint(CT_FALSE));
+  }
+
   if(def->read_types[1] == read_tuples) {
     if((SysInt)con.vars[0].size() != con.tuples->tupleSize()) {
       throw parse_exception("Tuple constraint with " + tostring(con.vars[0].size()) +
@@ -452,6 +539,14 @@ ConstraintBlob MinionThreeInputReader<FileReader>::readConstraintTable(FileReade
     }
   }
 
+  if(def->read_types[1] == read_smart_tuples &&
+     con.smartTuples->maxVar() >= (SysInt)con.vars[0].size()) {
+    throw parse_exception("The smart tuples '" + con.smartTuples->getName() +
+                          "' contain variable index " + tostring(con.smartTuples->maxVar()) +
+                          ", but the constraint only has " + tostring(con.vars[0].size()) +
+                          " variables (0 indexed)");
+  }
+
   // We already know there is at least one tuple
   if(con.vars[0].size() == 0) {
     if(def->read_types[1] == read_short_tuples && !(*con.shortTuples->tuplePtr())[0].empty())
@@ -504,6 +599,8 @@ ConstraintBlob MinionThreeInputReader<FileReader>::readGeneralConstraint(FileRea
         con.tuples2 = readConstraintTupleList(infile);
       else
         throw parse_exception("Too many tuplelists");
+      if((con.tuples2 ? con.tuples2 : con.tuples)->isMDDOnly())
+        throw parse_exception("MDDs can only be used by mddc");
       break;
     default: D_FATAL_ERROR("Internal Error!");
     }
@@ -523,6 +620,14 @@ MinionThreeInputReader<FileReader>::readConstraintShortTupleList(FileReader* inf
   return instance->getShortTableSymbol(name);
 }
 
+template <typename FileReader>
+SmartTupleList*
+MinionThreeInputReader<FileReader>::readConstraintSmartTupleList(FileReader* infile) {
+
+  string name = infile->getString();
+  return instance->getSmartTableSymbol(name);
+}
+
 template <typename FileReader>
 TupleList* MinionThreeInputReader<FileReader>::readConstraintTupleList(FileReader* infile) {
   TupleList* tuplelist;
@@ -531,7 +636,8 @@ TupleList* MinionThreeInputReader<FileReader>::readConstraintTupleList(FileReade
     string name = infile->getString();
     tuplelist = instance->getTableSymbol(name);
   } else {
-    vector<vector<DomainInt>> tuples;
+    // The tuples are stored one after another, as in a TupleList.
+    vector<DomainInt> tuples;
     infile->checkSym('{');
     char delim = infile->peekChar();
 
@@ -539,29 +645,26 @@ TupleList* MinionThreeInputReader<FileReader>::readConstraintTupleList(FileReade
 
     while(delim != '}') {
       infile->checkSym('<');
-      vector<DomainInt> tuple;
-      // Optimisation
-      tuple.reserve(tupleSize);
+      size_t tupleStart = tuples.size();
 
       char nextChar = ',';
       while(nextChar == ',') {
-        tuple.push_back(infile->readNum());
+        tuples.push_back(infile->readNum());
         nextChar = infile->getChar();
       }
       if(nextChar != '>')
         throw parse_exception("Expected ',' or '>'");
 
       if(tupleSize == 0)
-        tupleSize = tuple.size();
-      if(tupleSize != (SysInt)tuple.size())
+        tupleSize = tuples.size() - tupleStart;
+      if(tupleSize != (SysInt)(tuples.size() - tupleStart))
         throw parse_exception("All tuples in each constraint must be the same size!");
-      tuples.push_back(std::move(tuple));
 
       delim = infile->getChar(); // ',' or '}'
       if(delim != ',' && delim != '}')
         throw parse_exception("Expected ',' or '}'");
     }
-    tuplelist = instance->tupleListContainer->getNewTupleList(tuples);
+    tuplelist = instance->tupleListContainer->getNewTupleList(tuples, tupleSize);
     instance->addUnnamedTableSymbol(tuplelist);
   }
 
@@ -890,6 +993,156 @@ void MinionThreeInputReader<FileReader>::readShortTuples(FileReader* infile) {
   }
 }
 
+/// Read a set of the form {1,3..5,8}, which may be empty. The values are
+/// returned sorted, with no duplicates.
+template <typename FileReader>
+vector<DomainInt> MinionThreeInputReader<FileReader>::readSmartSet(FileReader* infile) {
+  vector<DomainInt> vals;
+  infile->checkSym('{');
+  if(infile->peekChar() == '}') {
+    infile->checkSym('}');
+    return vals;
+  }
+
+  char delim = ',';
+  while(delim == ',') {
+    DomainInt lower = infile->readNum();
+    DomainInt upper = lower;
+    if(infile->peekChar() == '.') {
+      infile->checkSym('.');
+      infile->checkSym('.');
+      upper = infile->readNum();
+    }
+    for(DomainInt i = lower; i <= upper; ++i)
+      vals.push_back(i);
+    delim = infile->getChar();
+  }
+  if(delim != '}')
+    throw parse_exception(string("Expected ',' or '}'. Got '") + delim + "'");
+
+  std::sort(vals.begin(), vals.end());
+  vals.erase(std::unique(vals.begin(), vals.end()), vals.end());
+  return vals;
+}
+
+/// Read a smart tuple, a list of conditions like [(x0 in {3..9}), (x1 != 2), (x0 < x2)]
+template <typename FileReader>
+SmartTuple MinionThreeInputReader<FileReader>::readSmartTuple(FileReader* infile) {
+  SmartTuple tuple;
+  infile->checkSym('[');
+
+  while(infile->peekChar() == '(') {
+    infile->checkSym('(');
+    infile->checkSym('x');
+    SysInt var = checked_cast<SysInt>(infile->readNum());
+    if(var < 0)
+      throw parse_exception("Smart tuples cannot contain the negative variable index " +
+                            tostring(var));
+
+    string op;
+    if(isalpha(infile->peekChar()))
+      op = infile->getString();
+    else {
+      op = string(1, infile->getChar());
+      if(infile->peekChar() == '=')
+        op += infile->getChar();
+    }
+
+    SysInt pos = tuple.getVar(var);
+    if(op == "in" || op == "notin") {
+      vector<DomainInt> vals = readSmartSet(infile);
+      // A single range is stored as bounds.
+      if(op == "in" && !vals.empty() && vals.back() - vals.front() + 1 == (DomainInt)vals.size())
+        tuple.vars[pos].restrictBounds(vals.front(), vals.back());
+      else if(op == "in")
+        tuple.vars[pos].restrictToSet(vals);
+      else
+        tuple.vars[pos].forbid(vals);
+    } else if(infile->peekChar() == 'x') {
+      infile->checkSym('x');
+      SysInt var2 = checked_cast<SysInt>(infile->readNum());
+      if(var2 < 0)
+        throw parse_exception("Smart tuples cannot contain the negative variable index " +
+                              tostring(var2));
+      if(var2 == var)
+        throw parse_exception("Smart tuples cannot relate x" + tostring(var) + " to itself");
+      SysInt pos2 = tuple.getVar(var2);
+      // Only '=', '!=', '<' and '<=' are stored, so '>' and '>=' swap sides.
+      if(op == ">" || op == ">=") {
+        std::swap(pos, pos2);
+        op = (op == ">") ? "<" : "<=";
+      }
+      SmartRelation rel;
+      if(op == "=")
+        rel = SMART_EQ;
+      else if(op == "!=")
+        rel = SMART_NEQ;
+      else if(op == "<")
+        rel = SMART_LT;
+      else if(op == "<=")
+        rel = SMART_LEQ;
+      else
+        throw parse_exception("Don't understand '" + op + "' in a smart tuple");
+      for(SysInt i = 0; i < (SysInt)tuple.binary.size(); ++i) {
+        const SmartBinaryCondition& b = tuple.binary[i];
+        if(b.first == pos || b.second == pos || b.first == pos2 || b.second == pos2)
+          throw parse_exception("Each variable can be in at most one binary condition of a "
+                                "smart tuple");
+      }
+      tuple.binary.push_back(SmartBinaryCondition(pos, rel, pos2));
+    } else {
+      DomainInt val = infile->readNum();
+      SmartVarCondition& c = tuple.vars[pos];
+      if(op == "=")
+        c.restrictBounds(val, val);
+      else if(op == "!=")
+        c.forbid(vector<DomainInt>(1, val));
+      else if(op == "<")
+        c.restrictBounds(DomainInt_Min, val - 1);
+      else if(op == "<=")
+        c.restrictBounds(DomainInt_Min, val);
+      else if(op == ">")
+        c.restrictBounds(val + 1, DomainInt_Max);
+      else if(op == ">=")
+        c.restrictBounds(val, DomainInt_Max);
+      else
+        throw parse_exception("Don't understand '" + op + "' in a smart tuple");
+    }
+
+    infile->checkSym(')');
+    if(infile->peekChar() == ',')
+      infile->checkSym(',');
+  }
+  infile->checkSym(']');
+
+  return tuple;
+}
+
+/// Read a list of smart tuples
+template <typename FileReader>
+void MinionThreeInputReader<FileReader>::readSmartTuples(FileReader* infile) {
+  while(infile->peekChar() != '*') {
+    string name = infile->getString();
+    DomainInt numOf_smartTuples = infile->readNum();
+    vector<SmartTuple> tups;
+
+    for(DomainInt i = 0; i < numOf_smartTuples; ++i) {
+      SmartTuple tuple = readSmartTuple(infile);
+      // Tuples which no assignment satisfies are dropped.
+      bool satisfiable = true;
+      for(SysInt j = 0; j < (SysInt)tuple.vars.size(); ++j)
+        satisfiable = tuple.vars[j].normalise() && satisfiable;
+      if(satisfiable)
+        tups.push_back(std::move(tuple));
+    }
+
+    MAYBE_PARSER_INFO("Read smart tuplelist '" + name + "', " + tostring(tups.size()) +
+                      " satisfiable tuples");
+    SmartTupleList* stl = instance->smartTupleListContainer->getNewSmartTupleList(tups);
+    instance->addSmartTableSymbol(name, stl);
+  }
+}
+
 template <typename FileReader>
 void MinionThreeInputReader<FileReader>::readTuples(FileReader* infile) {
   while(infile->peekChar() != '*') {
@@ -898,13 +1151,14 @@ void MinionThreeInputReader<FileReader>::readTuples(FileReader* infile) {
     DomainInt tupleLength = infile->readNum();
     MAYBE_PARSER_INFO("Reading tuplelist '" + name + "', length " + tostring(numOf_tuples) +
                       ", arity " + tostring(tupleLength));
+    if(numOf_tuples < 0 || tupleLength < 0)
+      throw parse_exception("The tuplelist '" + name + "' must have a non-negative size");
     TupleList* tuplelist =
         instance->tupleListContainer->getNewTupleList(numOf_tuples, tupleLength);
-    DomainInt* tuplePtr = tuplelist->getPointer();
-    for(DomainInt i = 0; i < numOf_tuples; ++i)
-      for(DomainInt j = 0; j < tupleLength; ++j) {
-        tuplePtr[checked_cast<SysInt>(i * tupleLength + j)] = infile->readNum();
-      }
+    // The tuples are read straight into the final table, as tables can be
+    // very large.
+    infile->readNums(tuplelist->getPointer(), (size_t)checked_cast<SysInt>(numOf_tuples) *
+                                                  (size_t)checked_cast<SysInt>(tupleLength));
     tuplelist->finalise_tuples();
     instance->addTableSymbol(name, tuplelist);
 
@@ -916,6 +1170,83 @@ void MinionThreeInputReader<FileReader>::readTuples(FileReader* infile) {
   }
 }
 
+/// Read a list of MDDs
+template <typename FileReader>
+void MinionThreeInputReader<FileReader>::readMDDs(FileReader* infile) {
+  while(infile->peekChar() != '*') {
+    string name = infile->getString();
+    SysInt arity = checked_cast<SysInt>(infile->readNum());
+    SysInt numOf_nodes = checked_cast<SysInt>(infile->readNum());
+    MAYBE_PARSER_INFO("Reading MDD '" + name + "', arity " + tostring(arity) + ", " +
+                      tostring(numOf_nodes) + " nodes");
+    if(arity < 1)
+      throw parse_exception("The MDD '" + name + "' must have arity at least 1");
+    if(numOf_nodes < 1)
+      throw parse_exception("The MDD '" + name + "' must have at least one node");
+
+    // Each node is a list of (value, child) pairs. A child of -1 is the tt node.
+    vector<vector<pair<DomainInt, SysInt>>> nodes(numOf_nodes);
+    for(SysInt i = 0; i < numOf_nodes; ++i) {
+      infile->checkSym('[');
+      while(infile->peekChar() == '(') {
+        infile->checkSym('(');
+        DomainInt val = infile->readNum();
+        infile->checkSym(',');
+        SysInt child = -1;
+        if(infile->peekChar() == 't')
+          infile->checkSym('t');
+        else {
+          child = checked_cast<SysInt>(infile->readNum());
+          if(child < 0 || child >= numOf_nodes)
+            throw parse_exception("The MDD '" + name + "' links to node " + tostring(child) +
+                                  ", but only has " + tostring(numOf_nodes) +
+                                  " nodes (0 indexed)");
+        }
+        infile->checkSym(')');
+        nodes[i].push_back(make_pair(val, child));
+        if(infile->peekChar() == ',')
+          infile->checkSym(',');
+      }
+      infile->checkSym(']');
+    }
+
+    // Check the MDD is layered: every node is reached at exactly one depth,
+    // and no node is reached at the depth of the arity.
+    vector<SysInt> layer(numOf_nodes, -1);
+    layer[0] = 0;
+    vector<SysInt> queue(1, 0);
+    for(SysInt q = 0; q < (SysInt)queue.size(); ++q) {
+      SysInt node = queue[q];
+      set<DomainInt> vals;
+      for(SysInt j = 0; j < (SysInt)nodes[node].size(); ++j) {
+        if(!vals.insert(nodes[node][j].first).second)
+          throw parse_exception("Node " + tostring(node) + " of the MDD '" + name +
+                                "' has more than one link for the value " +
+                                tostring(nodes[node][j].first));
+        SysInt child = nodes[node][j].second;
+        if(child == -1)
+          continue;
+        if(layer[node] + 1 >= arity)
+          throw parse_exception("The MDD '" + name + "' is deeper than its arity " +
+                                tostring(arity) + ": links from the last layer must go to t");
+        if(layer[child] == -1) {
+          layer[child] = layer[node] + 1;
+          queue.push_back(child);
+        } else if(layer[child] != layer[node] + 1) {
+          throw parse_exception("Node " + tostring(child) + " of the MDD '" + name +
+                                "' is reached at depths " + tostring(layer[child]) + " and " +
+                                tostring(layer[node] + 1));
+        }
+      }
+    }
+
+    MDD* mdd = MDDBuilder::fromNodeList(arity, nodes, layer);
+    MAYBE_PARSER_INFO("MDD '" + name + "' reduced to " + tostring(mdd->size()) + " nodes");
+    TupleList* tuplelist = instance->tupleListContainer->getNewTupleList(mdd, arity);
+    instance->addTableSymbol(name, tuplelist);
+  }
+}
+
 template <typename FileReader>
 void MinionThreeInputReader<FileReader>::readSearch(FileReader* infile) {
   while(infile->peekChar() != '*') {
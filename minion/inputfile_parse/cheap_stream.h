@@ -23,9 +23,17 @@
 
 #include <algorithm>
 #include <istream>
+#include <limits>
 #include <sstream>
 #include <string>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #ifdef P
 #undef P
 #endif
@@ -99,6 +107,56 @@ public:
     return streamPos == streamEnd;
   }
 
+  /// Reads 'count' integers, separated by whitespace or comments, into
+  /// 'out'. This is equivalent to reading them one at a time with getNum,
+  /// but is much faster for large blocks of numbers, such as tuplelists.
+  /// Returns false (and sets failFlag) if there is a problem.
+  template <typename T>
+  bool getNums(T* out, size_t count) {
+    const long long limit = std::numeric_limits<SysInt>::max() / 2;
+    const char* pos = streamPos;
+    const char* const end = streamEnd;
+
+    for(size_t n = 0; n < count; ++n) {
+      while(pos != end && (isspace(*pos) || *pos == '#')) {
+        if(*pos == '#') {
+          while(pos != end && *pos != '\n')
+            pos++;
+        } else
+          pos++;
+      }
+
+      bool negative = false;
+      if(pos != end && *pos == '-') {
+        negative = true;
+        pos++;
+      }
+
+      if(pos == end || *pos < '0' || *pos > '9') {
+        streamPos = pos;
+        failFlag = true;
+        return false;
+      }
+
+      long long i = 0;
+      do {
+        i = i * 10 + (*pos - '0');
+        pos++;
+        if(i > limit) {
+          std::cerr << "Magnitude of number too large!\n";
+          streamPos = pos;
+          failFlag = true;
+          return false;
+        }
+      } while(pos != end && *pos >= '0' && *pos <= '9');
+
+      out[n] = T(static_cast<SysInt>(negative ? -i : i));
+    }
+
+    streamPos = pos;
+    return true;
+  }
+
   string getline(char deliminator = '\n') {
     std::vector<char> output;
     while(streamPos != streamEnd) {
@@ -115,6 +173,60 @@ public:
   }
 };
 
+/// A read-only memory mapping of a whole regular file, so a CheapStream can
+/// read it without first copying it into memory. If the file cannot be
+/// mapped, ok() is false and the file should be read through an istream.
+class MappedFile {
+  void* data;
+  size_t length;
+
+  MappedFile(const MappedFile&);
+  void operator=(const MappedFile&);
+
+public:
+  MappedFile(const char* filename) : data(NULL), length(0) {
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    if(fd == -1)
+      return;
+    struct stat st;
+    // CheapStream reads the character after the end of its input, which
+    // must be 0. The rest of the last page of a mapping is zero, but if the
+    // file fills its last page exactly there is no such character, so the
+    // file is read normally.
+    if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+       st.st_size % sysconf(_SC_PAGESIZE) != 0) {
+      void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(p != MAP_FAILED) {
+        data = p;
+        length = st.st_size;
+        madvise(data, length, MADV_SEQUENTIAL);
+      }
+    }
+    close(fd);
+#endif
+  }
+
+  ~MappedFile() {
+#ifndef _WIN32
+    if(data != NULL)
+      munmap(data, length);
+#endif
+  }
+
+  bool ok() const {
+    return data != NULL;
+  }
+
+  const char* begin() const {
+    return static_cast<const char*>(data);
+  }
+
+  const char* end() const {
+    return static_cast<const char*>(data) + length;
+  }
+};
+
 template <typename T>
 void getNum(CheapStream& cs, T& ret) {
   SysInt negFlag = 1;
@@ -23,6 +23,7 @@
 #include "MinionThreeInputReader.hpp"
 #include <fstream>
 #include <iostream>
+#include <memory>
 
 template <typename Reader, typename Stream>
 void ReadCSP(Reader& reader, ConcreteFileReader<Stream>* infile) {
@@ -42,21 +43,27 @@ void readInputFromFiles(ProbSpec::CSPInstance& instance, vector<string> fnames,
     if(fname->find_last_of(".") < fname->size())
       extension = fname->substr(fname->find_last_of("."), fname->size());
 
-    // We need to use a pointer here, as we want to declare the object inside a
-    // for loop,
-    // and we need it to live until after we've finished parsing.
-    // We use an auto_ptr because it will auto-delete on exit.
-    istream* file;
+    // Regular files are mapped into memory and parsed in place. Anything
+    // else (stdin, pipes, files which cannot be mapped) is first read into
+    // memory through an istream.
+    std::unique_ptr<MappedFile> mapping;
+    std::unique_ptr<CheapStream> stream;
 
-    if(*fname != "--") {
-      file = new ifstream(filename, ios_base::in | ios_base::binary);
-      if(!(*file)) {
+    if(*fname != "--")
+      mapping.reset(new MappedFile(filename));
+
+    if(mapping && mapping->ok())
+      stream.reset(new CheapStream(mapping->begin(), mapping->end()));
+    else if(*fname != "--") {
+      ifstream file(filename, ios_base::in | ios_base::binary);
+      if(!file) {
         INPUT_ERROR("Can't open given input file '" + *fname + "'.");
       }
+      stream.reset(new CheapStream(file));
     } else
-      file = &cin;
+      stream.reset(new CheapStream(cin));
 
-    CheapStream cs(*file);
+    CheapStream& cs = *stream;
 
     ConcreteFileReader<CheapStream> infile(cs, filename);
 
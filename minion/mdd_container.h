@@ -0,0 +1,264 @@
+/*
+ * Minion http://minion.sourceforge.net
+ * Copyright (C) 2006-09
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+#ifndef _MDD_CONTAINER_H
+#define _MDD_CONTAINER_H
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+// This file contains multi-valued decision diagrams (MDDs), as used by mddc.
+// MDDs are built once per TupleList (or read directly from the input), and
+// shared between all the constraints which use them.
+
+struct MDDNode {
+  MDDNode(char _type) : id(-1), type(_type) {}
+
+  vector<std::pair<DomainInt, MDDNode*>> links; // pairs val,next, sorted by val
+  SysInt id;                                    // Integer that uniquely defines this node.
+  char type;                                    //   -1 is tt, 0 is normal, -2 is ff.
+};
+
+/// A reduced, layered MDD. Nodes in layer i branch on variable i. A tt node
+/// may be reached before the last layer, in which case all remaining
+/// variables are unconstrained.
+struct MDD {
+  MDDNode* top;
+  /// All nodes of the mdd, nodes[i]->id == i.
+  vector<MDDNode*> nodes;
+  SysInt arity;
+
+  MDD(SysInt _arity) : top(NULL), arity(_arity) {}
+
+  SysInt size() const {
+    return nodes.size();
+  }
+
+  /// True if the MDD contains no satisfying tuples.
+  bool empty() const {
+    return top->type == -2 || (top->type == 0 && top->links.empty());
+  }
+};
+
+/// Builds reduced MDDs by hash-consing: every node is looked up (by layer,
+/// type and links) once all its children are final, and replaced by an
+/// existing equal node if there is one. So equivalent subgraphs are only
+/// ever stored once.
+class MDDBuilder {
+  struct NodeHash {
+    size_t operator()(const MDDNode* n) const {
+      size_t hash_code = 1234 + n->type;
+      for(SysInt i = 0; i < (SysInt)n->links.size(); ++i) {
+        hash_code = (hash_code << 5) - hash_code + checked_cast<SysInt>(n->links[i].first);
+        hash_code = (hash_code << 5) - hash_code + n->links[i].second->id;
+      }
+      return hash_code;
+    }
+  };
+
+  struct NodeEqual {
+    bool operator()(const MDDNode* n1, const MDDNode* n2) const {
+      return n1->type == n2->type && n1->links == n2->links;
+    }
+  };
+
+  typedef std::unordered_set<MDDNode*, NodeHash, NodeEqual> NodeSet;
+
+  MDD* mdd;
+  // One set per layer. Nodes in different layers are never merged, as they
+  // branch on different variables.
+  vector<NodeSet> layers;
+  MDDNode* tt;
+  MDDNode* ff;
+
+  MDDNode* addNode(MDDNode* n) {
+    n->id = mdd->nodes.size();
+    mdd->nodes.push_back(n);
+    return n;
+  }
+
+public:
+  MDDBuilder(SysInt arity) : mdd(new MDD(arity)), layers(arity + 1), tt(NULL), ff(NULL) {}
+
+  /// Returns the unique node equal to 'n', which is at 'layer'. All of the
+  /// children of 'n' must already be unique. If this returns a node other
+  /// than 'n', 'n' is not part of the MDD and the caller should delete it.
+  MDDNode* intern(MDDNode* n, SysInt layer) {
+    if(n->type == -1 && n->links.empty()) {
+      if(tt == NULL)
+        tt = addNode(n);
+      return tt;
+    }
+    if(n->type == -2 && n->links.empty()) {
+      if(ff == NULL)
+        ff = addNode(n);
+      return ff;
+    }
+
+    std::pair<NodeSet::iterator, bool> it = layers[layer].insert(n);
+    if(it.second)
+      addNode(n);
+    return *(it.first);
+  }
+
+  /// Reduces an MDD given as a graph of nodes which have not been interned.
+  /// The graph may already share nodes. Nodes which are replaced are
+  /// deleted.
+  MDDNode* reduce(MDDNode* top) {
+    std::map<MDDNode*, MDDNode*> done;
+    vector<MDDNode*> replaced;
+    MDDNode* ret = reduce_recurse(top, 0, done, replaced);
+    for(SysInt i = 0; i < (SysInt)replaced.size(); ++i)
+      delete replaced[i];
+    return ret;
+  }
+
+  /// Takes the finished MDD, with top node 'top' (which must already be
+  /// interned). The builder should not be used afterwards.
+  MDD* finish(MDDNode* top) {
+    mdd->top = top;
+    MDD* ret = mdd;
+    mdd = NULL;
+    return ret;
+  }
+
+  /// Builds the MDD of a list of (positive) tuples. The tuples are visited in
+  /// lexicographic order, so only the current path through the MDD is ever
+  /// unreduced, and a node is interned as soon as the tuples stop passing
+  /// through it. This needs memory proportional to the size of the reduced
+  /// MDD, rather than the size of the trie of the tuples.
+  static MDD* fromTuples(TupleList* tuples) {
+    const SysInt tlsize = checked_cast<SysInt>(tuples->size());
+    const SysInt tuplelen = checked_cast<SysInt>(tuples->tupleSize());
+    const DomainInt* tupdata = tuples->getPointer();
+
+    vector<SysInt> order(tlsize);
+    for(SysInt i = 0; i < tlsize; ++i)
+      order[i] = i;
+    std::sort(order.begin(), order.end(), [tupdata, tuplelen](SysInt a, SysInt b) {
+      return std::lexicographical_compare(
+          tupdata + (size_t)a * tuplelen, tupdata + (size_t)(a + 1) * tuplelen,
+          tupdata + (size_t)b * tuplelen, tupdata + (size_t)(b + 1) * tuplelen);
+    });
+
+    MDDBuilder builder(tuplelen);
+
+    // path[i] is the (not yet interned) node at layer i on the path of the
+    // previous tuple.
+    vector<MDDNode*> path(tuplelen + 1, NULL);
+    path[0] = new MDDNode(tuplelen == 0 ? -1 : 0);
+    const DomainInt* prev = NULL;
+
+    for(SysInt t = 0; t < tlsize; ++t) {
+      const DomainInt* tup = tupdata + (size_t)order[t] * tuplelen;
+      SysInt common = 0;
+      if(prev != NULL) {
+        while(common < tuplelen && prev[common] == tup[common])
+          common++;
+        if(common == tuplelen)
+          continue; // Repeated tuple.
+        builder.internPath(path, common + 1);
+      }
+
+      for(SysInt i = common; i < tuplelen; ++i) {
+        MDDNode* newnode = new MDDNode(i == tuplelen - 1 ? -1 : 0);
+        path[i]->links.push_back(std::make_pair(tup[i], newnode));
+        path[i + 1] = newnode;
+      }
+      prev = tup;
+    }
+
+    if(prev != NULL)
+      builder.internPath(path, 1);
+    return builder.finish(builder.intern(path[0], 0));
+  }
+
+  /// Builds an MDD given as a list of nodes, as read from an **MDD** section.
+  /// Node 0 is the top node, and each node is a list of (value, child) pairs,
+  /// where a child of -1 is the tt node. The list must already have been
+  /// checked to be layered, with 'layer' giving the layer of each node
+  /// (-1 for unreachable nodes, which are ignored).
+  static MDD* fromNodeList(SysInt arity, const vector<vector<pair<DomainInt, SysInt>>>& nodelist,
+                           const vector<SysInt>& layer) {
+    MDDNode* tt = new MDDNode(-1);
+    vector<MDDNode*> built(nodelist.size(), NULL);
+    for(SysInt i = 0; i < (SysInt)nodelist.size(); ++i) {
+      if(layer[i] != -1)
+        built[i] = new MDDNode(0);
+    }
+
+    for(SysInt i = 0; i < (SysInt)nodelist.size(); ++i) {
+      if(built[i] == NULL)
+        continue;
+      vector<std::pair<DomainInt, MDDNode*>>& links = built[i]->links;
+      for(SysInt j = 0; j < (SysInt)nodelist[i].size(); ++j) {
+        SysInt child = nodelist[i][j].second;
+        links.push_back(std::make_pair(nodelist[i][j].first, child == -1 ? tt : built[child]));
+      }
+      std::sort(links.begin(), links.end());
+    }
+
+    MDDBuilder builder(arity);
+    MDD* mdd = builder.finish(builder.reduce(built[0]));
+    if(tt->id == -1)
+      delete tt; // Never used.
+    return mdd;
+  }
+
+private:
+  // Interns the nodes on 'path' from the bottom up to layer 'stop'. The last
+  // link of each node on the path points to the next node on the path.
+  void internPath(vector<MDDNode*>& path, SysInt stop) {
+    for(SysInt layer = (SysInt)path.size() - 1; layer >= stop; --layer) {
+      MDDNode* n = path[layer];
+      MDDNode* unique = intern(n, layer);
+      if(unique != n) {
+        path[layer - 1]->links.back().second = unique;
+        delete n;
+      }
+      path[layer] = NULL;
+    }
+  }
+
+  MDDNode* reduce_recurse(MDDNode* n, SysInt layer, std::map<MDDNode*, MDDNode*>& done,
+                          vector<MDDNode*>& replaced) {
+    std::map<MDDNode*, MDDNode*>::iterator it = done.find(n);
+    if(it != done.end())
+      return it->second;
+
+    for(SysInt i = 0; i < (SysInt)n->links.size(); ++i)
+      n->links[i].second = reduce_recurse(n->links[i].second, layer + 1, done, replaced);
+
+    MDDNode* unique = intern(n, layer);
+    if(unique != n)
+      replaced.push_back(n);
+    done[n] = unique;
+    return unique;
+  }
+};
+
+inline MDD* TupleList::getMDD() {
+  if(mdd == NULL)
+    mdd = MDDBuilder::fromTuples(this);
+  return mdd;
+}
+
+#endif
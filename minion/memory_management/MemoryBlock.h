@@ -309,6 +309,9 @@ public:
   ExtendableBlock requestBytesExtendable(UnsignedSysInt baseSize) {
     const SysInt maxSize = 512 * 1024 * 1024;
     char* block = (char*)calloc(maxSize, 1);
+    if(block == NULL) {
+      D_FATAL_ERROR("calloc failed - Memory exhausted! Aborting.");
+    }
     extendable_blocks.push_back(BlockDef{block, baseSize, maxSize});
     allocated_extendable_bytes += baseSize;
     return ExtendableBlock{block, (SysInt)extendable_blocks.size() - 1};
@@ -23,56 +23,218 @@
 
 #include "../system/system.h"
 
+// A set of bits, all set to begin with, which can only be cleared, and which
+// are restored on backtrack. Bits are packed 64 to a word, so ranges of bits
+// can be searched, counted and cleared a word at a time.
 class TrailedMonotonicSet {
-  vector<char> data;
+  typedef uint64_t Word;
+  static const SysInt WordBits = 64;
 
-  vector<SysInt> trailstack;
+  vector<Word> data;
+  SysInt bitCount;
+
+  // Each entry is a word, and the bits which were cleared in it.
+  vector<pair<SysInt, Word>> trailstack;
 
   vector<SysInt> trailstack_marks;
 
+  // The bits of a word from lo to hi (inclusive).
+  static Word rangeMask(SysInt lo, SysInt hi) {
+    return (~Word(0) >> (WordBits - 1 - hi)) & (~Word(0) << lo);
+  }
+
+  // Bits start to start + count - 1 of mask (count at most 64).
+  static Word extract(const Word* mask, SysInt start, SysInt count) {
+    SysInt w = start / WordBits;
+    SysInt shift = start % WordBits;
+    Word bits = mask[w] >> shift;
+    if(shift != 0 && shift + count > WordBits)
+      bits |= mask[w + 1] << (WordBits - shift);
+    return bits & rangeMask(0, count - 1);
+  }
+
+  // Calls f(word, mask) for each word overlapping [from, to], where mask
+  // covers the bits of that word inside the range.
+  template <typename F>
+  static void forEachWord(SysInt from, SysInt to, F f) {
+    for(SysInt w = from / WordBits; w <= to / WordBits; ++w) {
+      SysInt lo = (w == from / WordBits) ? from % WordBits : 0;
+      SysInt hi = (w == to / WordBits) ? to % WordBits : WordBits - 1;
+      f(w, rangeMask(lo, hi));
+    }
+  }
+
+  void clear(SysInt w, Word bits) {
+    D_ASSERT((data[w] & bits) == bits);
+    data[w] &= ~bits;
+    // Nothing is ever restored at the root.
+    if(trailstack_marks.size() == 1)
+      return;
+    // Clearing the same word again at this depth extends the last entry.
+    if((SysInt)trailstack.size() > trailstack_marks.back() && trailstack.back().first == w)
+      trailstack.back().second |= bits;
+    else
+      trailstack.push_back(make_pair(w, bits));
+  }
+
 public:
-  TrailedMonotonicSet() {
+  TrailedMonotonicSet() : bitCount(0) {
     trailstack_marks.push_back(0);
   }
 
   DomainInt size() const {
-    return data.size();
+    return bitCount;
   }
 
   void undo() {
-    SysInt i = (SysInt)trailstack.size() - 1;
-
     SysInt j = trailstack_marks.back();
     trailstack_marks.pop_back();
 
-    for(; i >= j; i--) {
-      D_ASSERT(!data[trailstack[i]]);
-      data[trailstack[i]] = true;
-      trailstack.pop_back();
+    for(SysInt i = (SysInt)trailstack.size() - 1; i >= j; i--) {
+      D_ASSERT((data[trailstack[i].first] & trailstack[i].second) == 0);
+      data[trailstack[i].first] |= trailstack[i].second;
     }
-    D_ASSERT((SysInt)trailstack.size() == j);
+    trailstack.resize(j);
   }
 
   bool ifMember_remove(DomainInt index) {
     SysInt i = checked_cast<SysInt>(index);
-    if(data[i]) {
-      data[i] = false;
-      trailstack.push_back(i);
+    Word bit = Word(1) << (i % WordBits);
+    if(data[i / WordBits] & bit) {
+      clear(i / WordBits, bit);
       return true;
     }
     return false;
   }
 
-  bool isMember(DomainInt index) {
+  bool isMember(DomainInt index) const {
     SysInt i = checked_cast<SysInt>(index);
-    return data[i];
+    return (data[i / WordBits] >> (i % WordBits)) & 1;
   }
 
   void unchecked_remove(DomainInt index) {
     SysInt i = checked_cast<SysInt>(index);
-    D_ASSERT(data[i]);
-    data[i] = false;
-    trailstack.push_back(i);
+    clear(i / WordBits, Word(1) << (i % WordBits));
+  }
+
+  /// The smallest member in [from, to], or to + 1 if there is none.
+  DomainInt nextMember(DomainInt from, DomainInt to) const {
+    SysInt f = checked_cast<SysInt>(from);
+    SysInt t = checked_cast<SysInt>(to);
+    if(f > t)
+      return to + 1;
+    SysInt last = t / WordBits;
+    SysInt w = f / WordBits;
+    Word bits = data[w] & (~Word(0) << (f % WordBits));
+    while(true) {
+      if(w == last)
+        bits &= rangeMask(0, t % WordBits);
+      if(bits)
+        return w * WordBits + __builtin_ctzll(bits);
+      if(w == last)
+        return to + 1;
+      bits = data[++w];
+    }
+  }
+
+  /// The largest member in [to, from], searching down from from, or to - 1
+  /// if there is none.
+  DomainInt prevMember(DomainInt from, DomainInt to) const {
+    SysInt f = checked_cast<SysInt>(from);
+    SysInt t = checked_cast<SysInt>(to);
+    if(f < t)
+      return to - 1;
+    SysInt last = t / WordBits;
+    SysInt w = f / WordBits;
+    Word bits = data[w] & rangeMask(0, f % WordBits);
+    while(true) {
+      if(w == last)
+        bits &= ~Word(0) << (t % WordBits);
+      if(bits)
+        return w * WordBits + (WordBits - 1 - __builtin_clzll(bits));
+      if(w == last)
+        return to - 1;
+      bits = data[--w];
+    }
+  }
+
+  /// The number of members in [from, to].
+  DomainInt countMembers(DomainInt from, DomainInt to) const {
+    SysInt count = 0;
+    if(from <= to)
+      forEachWord(checked_cast<SysInt>(from), checked_cast<SysInt>(to),
+                  [&](SysInt w, Word mask) { count += __builtin_popcountll(data[w] & mask); });
+    return count;
+  }
+
+  /// Calls f on each member in [from, to], in increasing order.
+  template <typename F>
+  void forEachMember(DomainInt from, DomainInt to, F f) const {
+    if(from > to)
+      return;
+    forEachWord(checked_cast<SysInt>(from), checked_cast<SysInt>(to), [&](SysInt w, Word mask) {
+      for(Word bits = data[w] & mask; bits; bits &= bits - 1)
+        f(DomainInt(w * WordBits + __builtin_ctzll(bits)));
+    });
+  }
+
+  /// Copies the bits for [from, to] into out, starting from bit 0 of out[0].
+  void copyMembers(DomainInt from, DomainInt to, Word* out) const {
+    SysInt start = checked_cast<SysInt>(from);
+    SysInt count = checked_cast<SysInt>(to - from + 1);
+    for(SysInt i = 0; i < count; i += WordBits) {
+      SysInt n = count - i < WordBits ? count - i : WordBits;
+      out[i / WordBits] = extract(data.data(), start + i, n);
+    }
+  }
+
+  /// Removes every member of [from, to], calling f on each one before it is
+  /// removed. Returns the number removed.
+  template <typename F>
+  DomainInt removeRange(DomainInt from, DomainInt to, F f) {
+    SysInt count = 0;
+    if(from > to)
+      return 0;
+    forEachWord(checked_cast<SysInt>(from), checked_cast<SysInt>(to), [&](SysInt w, Word mask) {
+      Word bits = data[w] & mask;
+      if(bits == 0)
+        return;
+      count += __builtin_popcountll(bits);
+      for(Word b = bits; b; b &= b - 1)
+        f(DomainInt(w * WordBits + __builtin_ctzll(b)));
+      clear(w, bits);
+    });
+    return count;
+  }
+
+  /// Removes every member i of [from, to] whose bit maskStart + (i - from)
+  /// is not set in mask, calling f on each one before it is removed.
+  /// Returns the number removed.
+  template <typename F>
+  DomainInt removeUnmasked(DomainInt from, DomainInt to, const Word* mask, DomainInt maskStart,
+                           F f) {
+    SysInt count = 0;
+    if(from > to)
+      return 0;
+    SysInt start = checked_cast<SysInt>(from);
+    SysInt offset = checked_cast<SysInt>(maskStart);
+    forEachWord(start, checked_cast<SysInt>(to), [&](SysInt w, Word range) {
+      Word bits = data[w] & range;
+      if(bits == 0)
+        return;
+      SysInt lo = __builtin_ctzll(range);
+      SysInt hi = WordBits - 1 - __builtin_clzll(range);
+      SysInt first = w * WordBits + lo;
+      Word keep = extract(mask, offset + first - start, hi - lo + 1) << lo;
+      bits &= ~keep;
+      if(bits == 0)
+        return;
+      count += __builtin_popcountll(bits);
+      for(Word b = bits; b; b &= b - 1)
+        f(DomainInt(w * WordBits + __builtin_ctzll(b)));
+      clear(w, bits);
+    });
+    return count;
   }
 
   void before_branch_left() {
@@ -88,8 +250,11 @@ public:
   {}
 
   DomainInt request_storage(DomainInt allocsize) {
-    SysInt i = data.size();
-    data.resize(i + checked_cast<SysInt>(allocsize), true);
+    SysInt i = bitCount;
+    bitCount += checked_cast<SysInt>(allocsize);
+    data.resize((bitCount + WordBits - 1) / WordBits, 0);
+    if(bitCount > i)
+      forEachWord(i, bitCount - 1, [&](SysInt w, Word mask) { data[w] |= mask; });
     return i;
   }
 };
@@ -28,6 +28,7 @@
 #include "inputfile_parse/inputfile_parse.h"
 
 #include "info_dumps.h"
+#include "presolve.h"
 
 #include "command_search.h"
 
@@ -155,6 +156,12 @@ int main(int argc, char** argv) {
     // Output graphs, stats, or redump (will not return in these cases)
     infoDumps(instance);
 
+    if(getOptions().symmetryBreak != SB_None)
+      addSymmetryBreaking(instance);
+
+    if(getOptions().presolve)
+      presolveInstance(instance);
+
     // Copy args into tableout
     getTableOut().set("RandomSeed", tostring(args.randomSeed));
     getTableOut().set("Preprocess", tostring(args.preprocess));
@@ -164,6 +171,14 @@ int main(int argc, char** argv) {
     getState().getOldTimer().maybePrintTimestepStore(cout, "Parsing Time: ", "ParsingTime",
                                                      getTableOut(), !getOptions().silent);
 
+    // SAC, SSAC, dynamic symmetry breaking and command search can remove
+    // values from the middle of any domain, so they need DISCRETE variables
+    // to stay DISCRETE.
+    if(args.preprocess.type == PropLevel_SAC || args.preprocess.type == PropLevel_SSAC ||
+       args.propMethod.type == PropLevel_SAC || args.propMethod.type == PropLevel_SSAC ||
+       getOptions().symmetryBreak == SB_Dynamic || getOptions().commandlistIn != "")
+      getOptions().keepVarTypes = true;
+
     SetupCSPOrdering(instance, args);
     BuildCSP(instance);
 
@@ -21,6 +21,232 @@
 #include "minion.h"
 
 #include "preprocess.h"
+
+#ifndef _WIN32
+#include <atomic>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Parallel SAC: each round forks worker processes, which hold a copy of the
+// solver state. Workers take variables from a shared counter, probe them as
+// propagateSAC_internal does, and publish the domain of any variable they
+// pruned. Before each variable a worker applies what the others have
+// published so far. The parent applies everything at the end of the round,
+// and stops after a round in which nothing was pruned. Every pruning is
+// sound for the (unique) SAC closure, so this reaches the same fixpoint as
+// the sequential algorithm.
+
+struct SACRoundHeader {
+  std::atomic<SysInt> nextTask;
+  std::atomic<SysInt> logSize;
+  std::atomic<SysInt> finished;
+  std::atomic<bool> failed;
+  std::atomic<bool> timedOut;
+};
+
+struct SACRound {
+  SysInt numvars;
+  vector<DomainInt> roundMin;  // bounds of each variable at the start of the round
+  vector<SysInt> removedStart; // offset into removed, or -1 if not needed
+
+  size_t mapSize;
+  SACRoundHeader* header;
+  std::atomic<SysInt>* log; // var+1 for each published variable, 0 if not yet written
+  DomainInt* bounds;        // published min and max of each variable
+  char* removed;            // published removed values between the bounds
+
+  SACRound(vector<AnyVarRef>& vars, bool onlyCheckBounds) : numvars(vars.size()) {
+    roundMin.resize(numvars);
+    removedStart.resize(numvars);
+    SysInt flags = 0;
+    for(SysInt i = 0; i < numvars; ++i) {
+      roundMin[i] = vars[i].min();
+      if(onlyCheckBounds || vars[i].isBound() || vars[i].isAssigned()) {
+        removedStart[i] = -1;
+      } else {
+        removedStart[i] = flags;
+        flags += checked_cast<SysInt>(vars[i].max() - vars[i].min() + 1);
+      }
+    }
+
+    mapSize = sizeof(SACRoundHeader) + sizeof(std::atomic<SysInt>) * numvars +
+              sizeof(DomainInt) * 2 * numvars + flags;
+    void* mem = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+    if(mem == MAP_FAILED) {
+      D_FATAL_ERROR("Parallel SAC shared memory setup failed");
+    }
+    char* ptr = (char*)mem;
+    header = new(ptr) SACRoundHeader();
+    ptr += sizeof(SACRoundHeader);
+    log = (std::atomic<SysInt>*)ptr;
+    for(SysInt i = 0; i < numvars; ++i)
+      new(log + i) std::atomic<SysInt>(0);
+    ptr += sizeof(std::atomic<SysInt>) * numvars;
+    bounds = (DomainInt*)ptr;
+    ptr += sizeof(DomainInt) * 2 * numvars;
+    removed = ptr;
+    header->nextTask = 0;
+    header->logSize = 0;
+    header->finished = 0;
+    header->failed = false;
+    header->timedOut = false;
+  }
+
+  ~SACRound() {
+    munmap(header, mapSize);
+  }
+
+  // Publishes the current domain of vars[i]. Each variable is probed by only
+  // one worker in a round, so its slot is written at most once.
+  void publish(AnyVarRef& var, SysInt i) {
+    bounds[2 * i] = var.min();
+    bounds[2 * i + 1] = var.max();
+    if(removedStart[i] != -1) {
+      for(DomainInt val = var.min(); val <= var.max(); ++val)
+        removed[removedStart[i] + checked_cast<SysInt>(val - roundMin[i])] = !var.inDomain(val);
+    }
+    SysInt pos = header->logSize.fetch_add(1);
+    log[pos].store(i + 1, std::memory_order_release);
+  }
+
+  // Applies the published domains from position 'seen' in the log, and
+  // propagates if anything was applied. Returns the new position.
+  template <typename Prop>
+  SysInt apply(vector<AnyVarRef>& vars, SysInt seen, Prop prop) {
+    bool changed = false;
+    while(seen < numvars && !getState().isFailed()) {
+      SysInt entry = log[seen].load(std::memory_order_acquire);
+      if(entry == 0)
+        break;
+      seen++;
+      SysInt i = entry - 1;
+      AnyVarRef& var = vars[i];
+      var.setMin(bounds[2 * i]);
+      var.setMax(bounds[2 * i + 1]);
+      if(removedStart[i] != -1) {
+        for(DomainInt val = bounds[2 * i] + 1; val < bounds[2 * i + 1]; ++val) {
+          if(removed[removedStart[i] + checked_cast<SysInt>(val - roundMin[i])] &&
+             var.inDomain(val))
+            var.removeFromDomain(val);
+        }
+      }
+      changed = true;
+    }
+    if(changed && !getState().isFailed())
+      prop(vars);
+    return seen;
+  }
+};
+
+template <typename Prop>
+void SACWorker(vector<AnyVarRef>& vars, Prop prop, bool onlyCheckBounds, SACRound& round) {
+  SysInt seen = 0;
+  try {
+    while(!round.header->failed) {
+      SysInt i = round.header->nextTask.fetch_add(1);
+      if(i >= round.numvars)
+        break;
+      seen = round.apply(vars, seen, prop);
+      if(getState().isFailed())
+        break;
+      if(Parallel::isAlarmActivated())
+        throw EndOfSearch();
+
+      AnyVarRef& var = vars[i];
+      if(var.isAssigned())
+        continue;
+      bool pruned = pruneDomain_bottom(var, vars, prop, false);
+      if(!getState().isFailed() && pruneDomainTop(var, vars, prop, false))
+        pruned = true;
+      if(!onlyCheckBounds && !var.isBound()) {
+        for(DomainInt val = var.min() + 1; val <= var.max() - 1 && !getState().isFailed();
+            ++val) {
+          if(checkSACTimeout())
+            throw EndOfSearch();
+          if(var.inDomain(val) && check_fail(var, val, vars, prop)) {
+            pruned = true;
+            var.removeFromDomain(val);
+            prop(vars);
+          }
+        }
+      }
+      if(getState().isFailed())
+        break;
+      if(pruned)
+        round.publish(var, i);
+    }
+  } catch(EndOfSearch) { round.header->timedOut = true; }
+
+  if(getState().isFailed())
+    round.header->failed = true;
+  round.header->finished++;
+}
+
+template <typename Prop>
+void propagateSAC_parallel(vector<AnyVarRef>& vars, Prop prop, bool onlyCheckBounds, int cores) {
+  getQueue().propagateQueue();
+  if(getState().isFailed())
+    return;
+
+  bool reduced = true;
+  while(reduced) {
+    SACRound round(vars, onlyCheckBounds);
+
+    cout.flush();
+    vector<pid_t> workers;
+    for(int c = 0; c < cores; ++c) {
+      pid_t pid = fork();
+      if(pid < 0) {
+        D_FATAL_ERROR("Fork fail in parallel SAC");
+      }
+      if(pid == 0) {
+        getOptions().silent = true;
+        SACWorker(vars, prop, onlyCheckBounds, round);
+        _exit(0);
+      }
+      workers.push_back(pid);
+    }
+
+    // SIGCHLD may be ignored, in which case waitpid only returns once the
+    // workers have gone, so check they all finished properly.
+    for(SysInt c = 0; c < (SysInt)workers.size(); ++c)
+      waitpid(workers[c], NULL, 0);
+    if(round.header->finished != cores) {
+      D_FATAL_ERROR("A parallel SAC worker was lost");
+    }
+
+    if(round.header->timedOut && checkSACTimeout())
+      throw EndOfSearch();
+    if(round.header->failed) {
+      getState().setFailed(true);
+      return;
+    }
+
+    reduced = (round.header->logSize > 0);
+    round.apply(vars, 0, prop);
+    if(getState().isFailed())
+      return;
+  }
+}
+#endif
+
+// Runs SAC to a fixpoint, on several cores if asked to. The '_limit'
+// variants stop early in an order-dependent way, so they stay sequential.
+template <typename Prop>
+void propagateSAC_cores(vector<AnyVarRef>& vars, Prop prop, bool onlyCheckBounds,
+                        PropagationLevel level) {
+#ifndef _WIN32
+  int cores = std::min<int>(getOptions().preprocessCores, vars.size());
+  if(cores > 1 && !level.limit && !getOptions().gatherAMOs) {
+    propagateSAC_parallel(vars, prop, onlyCheckBounds, cores);
+    return;
+  }
+#endif
+  SACResidues residues;
+  propagateSAC_internal(vars, prop, onlyCheckBounds, level.limit, &residues);
+}
+
 /// Apply a high level of consistency to a CSP.
 /** This function is not particularly optimised, implementing only the most
  * basic SAC and SSAC algorithms */
@@ -38,13 +264,7 @@ void PropogateCSP(PropagationLevel preprocessLevel, vector<AnyVarRef>& vars, boo
   bool boundsCheck = ((preprocessLevel.type == PropLevel_SACBounds) ||
                       (preprocessLevel.type == PropLevel_SSACBounds));
 
-  if(boundsCheck) {
-    PropagateSAC_Bounds prop_SACBounds(preprocessLevel);
-    prop_SACBounds(vars);
-  } else {
-    PropagateSAC prop_SAC(preprocessLevel);
-    prop_SAC(vars);
-  }
+  propagateSAC_cores(vars, propGAC, boundsCheck, preprocessLevel);
 
   if(printInfo) {
     cout << "SAC" << (boundsCheck ? "Bounds" : "") << " Removed " << (lits - litCount(vars))
@@ -55,13 +275,7 @@ void PropogateCSP(PropagationLevel preprocessLevel, vector<AnyVarRef>& vars, boo
     return;
 
   lits = litCount(vars);
-  if(boundsCheck) {
-    PropagateSSAC_Bounds prop_SSACBounds(preprocessLevel);
-    prop_SSACBounds(vars);
-  } else {
-    PropagateSSAC prop_SSAC(preprocessLevel);
-    prop_SSAC(vars);
-  }
+  propagateSAC_cores(vars, PropagateSAC(preprocessLevel), boundsCheck, preprocessLevel);
   if(printInfo) {
     cout << "SSAC" << (boundsCheck ? "Bounds" : "") << " Removed " << (lits - litCount(vars))
          << " literals" << endl;
@@ -23,6 +23,230 @@
 
 #include "solver.h"
 
+#include "constraints/constraint_collect_events.h"
+
+// Support residues for SAC, in the style of SAC-SDS. A successful probe of
+// (var, val) ends in a propagated subdomain P, and probing it again can only
+// fail once something in P has been removed. We keep a log of the literals
+// removed from the domains, and record for each successful probe the
+// position in the log it was made at, and the bounds in P of each variable
+// the probe changed. A probe is repeated only when a literal removed since
+// then may be in P: a literal of a variable the probe did not change, or
+// one inside the bounds the probe left.
+//
+// The log is brought up to date with the domains at the start of each SAC
+// call, so it can be kept during search. Literals which come back on
+// backtracking are popped from the log, along with everything removed after
+// them, which throws away the records of every probe made in the meantime.
+struct SACResidues {
+  struct VarBounds {
+    SysInt var;
+    DomainInt min;
+    DomainInt max;
+  };
+
+  struct Record {
+    SysInt pos;                // log position of the probe, or -1 if there is no record
+    SysInt stamp;              // id of the log entry before pos, or 0
+    vector<VarBounds> changed; // sorted by variable
+    Record() : pos(-1), stamp(0) {}
+  };
+
+  // Past these sizes we do not keep residues, and SAC probes everything.
+  static const SysInt maxLiterals = 1 << 20;
+  static const SysInt maxStored = 1 << 22;
+
+  SysInt numVars; // the residues are for vectors of this size, or -1
+  bool disabled;
+  bool fullSync;
+
+  vector<SysInt> litStart; // first literal of each variable, plus the total
+  vector<DomainInt> initMin;
+
+  vector<char> known;       // literal is in the domain, as far as the log knows
+  vector<SysInt> knownSize; // number of known literals of each variable
+  vector<SysInt> logPos;    // position in the log of each removed literal
+  vector<SysInt> logVar;
+  vector<DomainInt> logVal;
+  vector<SysInt> logId;
+  SysInt nextId;
+
+  vector<Record> records;
+  SysInt stored;
+
+  // The variables changed since the log was last brought up to date.
+  CollectChanges<vector<AnyVarRef>>* changes;
+
+  SACResidues()
+      : numVars(-1), disabled(false), fullSync(true), nextId(1), stored(0), changes(NULL) {}
+
+  ~SACResidues() {
+    // 'changes' is not freed, as released triggers may still point at it.
+    if(changes != NULL)
+      changes->releaseTriggers();
+  }
+
+  SysInt literal(SysInt var, DomainInt val) {
+    return litStart[var] + checked_cast<SysInt>(val - initMin[var]);
+  }
+
+  template <typename Vars>
+  void initialise(Vars& vars) {
+    numVars = vars.size();
+    DomainInt total = 0;
+    for(SysInt i = 0; i < numVars; ++i)
+      total += vars[i].initialMax() - vars[i].initialMin() + 1;
+    if(total > maxLiterals) {
+      disabled = true;
+      return;
+    }
+    litStart.resize(numVars + 1);
+    initMin.resize(numVars);
+    knownSize.resize(numVars);
+    SysInt pos = 0;
+    for(SysInt i = 0; i < numVars; ++i) {
+      litStart[i] = pos;
+      initMin[i] = vars[i].initialMin();
+      knownSize[i] = checked_cast<SysInt>(vars[i].initialMax() - vars[i].initialMin() + 1);
+      pos += knownSize[i];
+    }
+    litStart[numVars] = pos;
+    known.resize(pos, 1);
+    logPos.resize(pos, -1);
+    records.resize(pos);
+
+    vector<AnyVarRef> anyvars;
+    for(SysInt i = 0; i < numVars; ++i)
+      anyvars.push_back(vars[i]);
+    changes = new CollectChanges<vector<AnyVarRef>>(anyvars);
+    changes->setup();
+    changes->fullPropagate();
+    changes->fullPropagateDone = true;
+    // The first update looks at every variable.
+    for(SysInt i = 0; i < numVars; ++i)
+      changes->mark(i);
+  }
+
+  /// Called at the start of a SAC call, as the domains may have changed in
+  /// any way since the last one.
+  void startCall() {
+    fullSync = true;
+  }
+
+  void logRemoval(SysInt var, DomainInt val) {
+    SysInt lit = literal(var, val);
+    known[lit] = 0;
+    knownSize[var]--;
+    logPos[lit] = logVar.size();
+    logVar.push_back(var);
+    logVal.push_back(val);
+    logId.push_back(nextId++);
+  }
+
+  // Brings the log up to date with the domains. Without fullSync, the
+  // domains must only have shrunk since the last call.
+  template <typename Vars>
+  void sync(Vars& vars) {
+    if(fullSync) {
+      fullSync = false;
+      SysInt trunc = logVar.size();
+      for(SysInt i = 0; i < numVars; ++i) {
+        if(knownSize[i] == litStart[i + 1] - litStart[i])
+          continue;
+        for(SysInt lit = litStart[i]; lit < litStart[i + 1]; ++lit) {
+          if(!known[lit] && logPos[lit] < trunc &&
+             vars[i].inDomain(initMin[i] + (lit - litStart[i])))
+            trunc = logPos[lit];
+        }
+      }
+      while((SysInt)logVar.size() > trunc) {
+        SysInt var = logVar.back();
+        known[literal(var, logVal.back())] = 1;
+        knownSize[var]++;
+        changes->mark(var);
+        logVar.pop_back();
+        logVal.pop_back();
+        logId.pop_back();
+      }
+    }
+
+    for(SysInt j = 0; j < (SysInt)changes->changedList.size(); ++j) {
+      SysInt i = changes->changedList[j];
+      DomainInt min = vars[i].min();
+      DomainInt max = vars[i].max();
+      for(SysInt lit = litStart[i]; lit < litStart[i + 1]; ++lit) {
+        DomainInt val = initMin[i] + (lit - litStart[i]);
+        if(known[lit] && (val < min || val > max || !vars[i].inDomain_noBoundCheck(val)))
+          logRemoval(i, val);
+      }
+    }
+    changes->clear();
+  }
+
+  /// Brings the residues up to date before a probe. Returns false if
+  /// residues are not being kept.
+  template <typename Vars>
+  bool prepare(Vars& vars) {
+    if(numVars != (SysInt)vars.size()) {
+      if(changes != NULL)
+        changes->releaseTriggers();
+      *this = SACResidues();
+      initialise(vars);
+    }
+    if(disabled)
+      return false;
+    sync(vars);
+    return true;
+  }
+
+  static bool lessVar(const VarBounds& b, SysInt var) {
+    return b.var < var;
+  }
+
+  /// Returns true if probing vars[var] = val is known to succeed.
+  bool supported(SysInt var, DomainInt val) {
+    const Record& r = records[literal(var, val)];
+    SysInt len = logVar.size();
+    if(r.pos < 0 || r.pos > len || (r.pos > 0 && logId[r.pos - 1] != r.stamp))
+      return false;
+    for(SysInt k = r.pos; k < len; ++k) {
+      vector<VarBounds>::const_iterator it =
+          std::lower_bound(r.changed.begin(), r.changed.end(), logVar[k], lessVar);
+      if(it == r.changed.end() || it->var != logVar[k])
+        return false;
+      if(logVal[k] >= it->min && logVal[k] <= it->max)
+        return false;
+    }
+    return true;
+  }
+
+  /// Records a successful probe of vars[var] = val, from inside the probe.
+  /// Must follow a call to prepare for the same probe.
+  template <typename Vars>
+  void record(Vars& vars, SysInt var, DomainInt val) {
+    Record& r = records[literal(var, val)];
+    stored -= r.changed.size();
+    r.changed.clear();
+    r.pos = -1;
+    vector<SysInt>& changed = changes->changedList;
+    if(stored + (SysInt)changed.size() > maxStored)
+      return;
+    std::sort(changed.begin(), changed.end());
+    for(SysInt j = 0; j < (SysInt)changed.size(); ++j) {
+      VarBounds b = {changed[j], vars[changed[j]].min(), vars[changed[j]].max()};
+      r.changed.push_back(b);
+    }
+    stored += r.changed.size();
+    r.pos = logVar.size();
+    r.stamp = (r.pos > 0) ? logId[r.pos - 1] : 0;
+  }
+
+  /// Called after each probe, which leaves the domains as they were.
+  void endProbe() {
+    changes->clear();
+  }
+};
+
 template <typename Var, typename Vars, typename Prop>
 bool inline check_fail(Var& var, DomainInt val, Vars& vars, Prop prop) {
   Controller::worldPush();
@@ -36,6 +260,30 @@ bool inline check_fail(Var& var, DomainInt val, Vars& vars, Prop prop) {
   return checkFailed;
 }
 
+// As check_fail, where var is vars[index]. Skips the probe if the residues
+// show it succeeds, and records it if it does.
+template <typename Vars, typename Prop>
+bool inline check_fail_residues(SysInt index, DomainInt val, Vars& vars, Prop prop,
+                                SACResidues* residues) {
+  if(residues == NULL || !residues->prepare(vars))
+    return check_fail(vars[index], val, vars, prop);
+  if(residues->supported(index, val))
+    return false;
+
+  Controller::worldPush();
+  vars[index].assign(val);
+  prop(vars);
+
+  bool checkFailed = getState().isFailed();
+  if(!checkFailed)
+    residues->record(vars, index, val);
+
+  Controller::worldPop();
+  residues->endProbe();
+
+  return checkFailed;
+}
+
 // Copied from dump_state.cpp
 template <typename T>
 inline string getNameFromVar(const T& v) {
@@ -73,7 +321,8 @@ inline bool checkSACTimeout() {
 }
 
 template <typename Var, typename Prop>
-bool pruneDomainTop(Var& var, vector<Var>& vararray, Prop prop, bool limit) {
+bool pruneDomainTop(Var& var, vector<Var>& vararray, Prop prop, bool limit,
+                    SACResidues* residues = NULL, SysInt index = -1) {
   bool pruned = false;
   bool everfailed = false;
   DomainInt gallop = 1;
@@ -85,7 +334,10 @@ bool pruneDomainTop(Var& var, vector<Var>& vararray, Prop prop, bool limit) {
     }
     DomainInt maxval = var.max();
     DomainInt step = maxval - gallop;
-    bool check = check_fail_range(var, step + 1, maxval, vararray, prop);
+    // The first probe of each bound is of a single value, so can use residues.
+    bool check = (gallop == 1 && residues != NULL)
+                     ? check_fail_residues(index, maxval, vararray, prop, residues)
+                     : check_fail_range(var, step + 1, maxval, vararray, prop);
     if(check) {
       pruned = true;
       var.setMax(step);
@@ -112,7 +364,8 @@ bool pruneDomainTop(Var& var, vector<Var>& vararray, Prop prop, bool limit) {
 }
 
 template <typename Var, typename Prop>
-bool pruneDomain_bottom(Var& var, vector<Var>& vararray, Prop prop, bool limit) {
+bool pruneDomain_bottom(Var& var, vector<Var>& vararray, Prop prop, bool limit,
+                        SACResidues* residues = NULL, SysInt index = -1) {
   bool pruned = false;
   bool everfailed = false;
   DomainInt gallop = 1;
@@ -124,7 +377,10 @@ bool pruneDomain_bottom(Var& var, vector<Var>& vararray, Prop prop, bool limit)
     }
     DomainInt minval = var.min();
     DomainInt step = minval + gallop;
-    bool check = check_fail_range(var, minval, step - 1, vararray, prop);
+    // The first probe of each bound is of a single value, so can use residues.
+    bool check = (gallop == 1 && residues != NULL)
+                     ? check_fail_residues(index, minval, vararray, prop, residues)
+                     : check_fail_range(var, minval, step - 1, vararray, prop);
     if(check) {
       pruned = true;
       var.setMin(step);
@@ -150,13 +406,14 @@ bool pruneDomain_bottom(Var& var, vector<Var>& vararray, Prop prop, bool limit)
   }
 }
 
-#include "constraints/constraint_collect_events.h"
-
 template <typename Var, typename Prop>
-void propagateSAC_internal(vector<Var>& vararray, Prop prop, bool onlyCheckBounds, bool limit) {
+void propagateSAC_internal(vector<Var>& vararray, Prop prop, bool onlyCheckBounds, bool limit,
+                           SACResidues* residues = NULL) {
   getQueue().propagateQueue();
   if(getState().isFailed())
     return;
+  if(residues != NULL)
+    residues->startCall();
   bool reduced = true;
   int loops = 0;
 
@@ -178,11 +435,11 @@ void propagateSAC_internal(vector<Var>& vararray, Prop prop, bool onlyCheckBound
         //std::cerr << "Bound loop: " << i << std::endl;
         Var& var = vararray[i];
         if(!var.isAssigned()) {
-          if(pruneDomain_bottom(var, vararray, prop, limit))
+          if(pruneDomain_bottom(var, vararray, prop, limit, residues, i))
             reduced = true;
           if(getState().isFailed())
             return;
-          if(pruneDomainTop(var, vararray, prop, limit))
+          if(pruneDomainTop(var, vararray, prop, limit, residues, i))
             reduced = true;
           if(getState().isFailed())
             return;
@@ -201,7 +458,7 @@ void propagateSAC_internal(vector<Var>& vararray, Prop prop, bool onlyCheckBound
           for(DomainInt val = var.min() + 1; val <= var.max() - 1; ++val) {
             if(checkSACTimeout())
               throw EndOfSearch();
-            if(var.inDomain(val) && check_fail(var, val, vararray, prop)) {
+            if(var.inDomain(val) && check_fail_residues(i, val, vararray, prop, residues)) {
               reduced = true;
               var.removeFromDomain(val);
               prop(vararray);
@@ -304,50 +561,58 @@ struct PropagateGAC {
   }
 };
 
+// The SAC propagators keep their residues from one call to the next (and
+// share them between copies), so SAC at each node of search only repeats
+// the probes which may have changed.
 struct PropagateSAC {
   PropagationLevel level;
+  shared_ptr<SACResidues> residues;
 
-  PropagateSAC(PropagationLevel _level) : level(_level) {}
+  PropagateSAC(PropagationLevel _level) : level(_level), residues(new SACResidues()) {}
 
   template <typename Vars>
   void operator()(Vars& vars) {
-    propagateSAC_internal(vars, PropagateGAC(level), false, level.limit);
+    propagateSAC_internal(vars, PropagateGAC(level), false, level.limit, residues.get());
   }
 };
 
 struct PropagateSAC_Bounds {
   PropagationLevel level;
+  shared_ptr<SACResidues> residues;
 
-  PropagateSAC_Bounds(PropagationLevel _level) : level(_level) {}
+  PropagateSAC_Bounds(PropagationLevel _level) : level(_level), residues(new SACResidues()) {}
 
   template <typename Vars>
   void operator()(Vars& vars) {
-    propagateSAC_internal(vars, PropagateGAC(level), true, level.limit);
+    propagateSAC_internal(vars, PropagateGAC(level), true, level.limit, residues.get());
   }
 };
 
 struct PropagateSSAC {
   PropagationLevel level;
+  PropagateSAC sac;
+  shared_ptr<SACResidues> residues;
 
-  PropagateSSAC(PropagationLevel _level) : level(_level) {}
+  PropagateSSAC(PropagationLevel _level)
+      : level(_level), sac(_level), residues(new SACResidues()) {}
 
   template <typename Vars>
   void operator()(Vars& vars) {
-    PropagateSAC sac(level);
-    ;
-    propagateSAC_internal(vars, sac, false, level.limit);
+    propagateSAC_internal(vars, sac, false, level.limit, residues.get());
   }
 };
 
 struct PropagateSSAC_Bounds {
   PropagationLevel level;
+  PropagateSAC sac;
+  shared_ptr<SACResidues> residues;
 
-  PropagateSSAC_Bounds(PropagationLevel _level) : level(_level) {}
+  PropagateSSAC_Bounds(PropagationLevel _level)
+      : level(_level), sac(_level), residues(new SACResidues()) {}
 
   template <typename Vars>
   void operator()(Vars& vars) {
-    PropagateSAC sac(level);
-    propagateSAC_internal(vars, sac, true, level.limit);
+    propagateSAC_internal(vars, sac, true, level.limit, residues.get());
   }
 };
 
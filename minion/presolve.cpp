@@ -0,0 +1,654 @@
+/*
+ * Minion http://minion.sourceforge.net
+ * Copyright (C) 2006-09
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+#include "presolve.h"
+
+namespace {
+
+// The domain of a variable, as presolve sees it. Sparse bound variables
+// keep their list of values, all other variables are intervals, so only
+// their ends can be removed.
+struct PresolveDomain {
+  bool sparse;
+  DomainInt lower;
+  DomainInt upper;
+  vector<DomainInt> values;
+
+  PresolveDomain() : sparse(false), lower(0), upper(-1) {}
+
+  PresolveDomain(DomainInt _lower, DomainInt _upper)
+      : sparse(false), lower(_lower), upper(_upper) {}
+
+  PresolveDomain(const vector<DomainInt>& _values) : sparse(true), values(_values) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    updateBounds();
+  }
+
+  void updateBounds() {
+    if(values.empty()) {
+      lower = 1;
+      upper = 0;
+    } else {
+      lower = values.front();
+      upper = values.back();
+    }
+  }
+
+  bool empty() const {
+    return lower > upper;
+  }
+
+  bool fixed() const {
+    return lower == upper;
+  }
+
+  DomainInt size() const {
+    return sparse ? DomainInt(values.size()) : upper - lower + 1;
+  }
+
+  bool contains(DomainInt v) const {
+    if(sparse)
+      return std::binary_search(values.begin(), values.end(), v);
+    return lower <= v && v <= upper;
+  }
+
+  friend bool operator==(const PresolveDomain& a, const PresolveDomain& b) {
+    return a.sparse == b.sparse && a.lower == b.lower && a.upper == b.upper &&
+           a.values == b.values;
+  }
+
+  friend bool operator!=(const PresolveDomain& a, const PresolveDomain& b) {
+    return !(a == b);
+  }
+
+  void intersectRange(DomainInt a, DomainInt b) {
+    if(sparse) {
+      values.erase(std::remove_if(values.begin(), values.end(),
+                                  [&](DomainInt v) { return v < a || v > b; }),
+                   values.end());
+      updateBounds();
+    } else {
+      lower = std::max(lower, a);
+      upper = std::min(upper, b);
+    }
+  }
+
+  void removeRange(DomainInt a, DomainInt b) {
+    if(sparse) {
+      values.erase(std::remove_if(values.begin(), values.end(),
+                                  [&](DomainInt v) { return a <= v && v <= b; }),
+                   values.end());
+      updateBounds();
+    } else {
+      if(a <= lower)
+        lower = std::max(lower, b + 1);
+      if(b >= upper)
+        upper = std::min(upper, a - 1);
+    }
+  }
+
+  // set must be sorted.
+  void intersectSet(const vector<DomainInt>& set) {
+    if(sparse) {
+      values.erase(std::remove_if(values.begin(), values.end(),
+                                  [&](DomainInt v) {
+                                    return !std::binary_search(set.begin(), set.end(), v);
+                                  }),
+                   values.end());
+      updateBounds();
+    } else {
+      auto first = std::lower_bound(set.begin(), set.end(), lower);
+      auto last = std::upper_bound(set.begin(), set.end(), upper);
+      if(first == last) {
+        lower = 1;
+        upper = 0;
+      } else {
+        lower = *first;
+        upper = *(last - 1);
+      }
+    }
+  }
+
+  // set must be sorted.
+  void removeSet(const vector<DomainInt>& set) {
+    if(sparse) {
+      values.erase(std::remove_if(values.begin(), values.end(),
+                                  [&](DomainInt v) {
+                                    return std::binary_search(set.begin(), set.end(), v);
+                                  }),
+                   values.end());
+      updateBounds();
+    } else {
+      while(lower <= upper && std::binary_search(set.begin(), set.end(), lower))
+        lower++;
+      while(lower <= upper && std::binary_search(set.begin(), set.end(), upper))
+        upper--;
+    }
+  }
+};
+
+// A unary constraint: the variable is in (or not in) a set or range.
+struct Restriction {
+  enum Kind { InSet, NotInSet, InRange, NotInRange };
+  Kind kind;
+  // Sorted values for sets, or the two ends of a range.
+  vector<DomainInt> vals;
+
+  Restriction(Kind _kind, vector<DomainInt> _vals) : kind(_kind), vals(std::move(_vals)) {
+    std::sort(vals.begin(), vals.end());
+  }
+
+  // The same restriction on the negation of a boolean.
+  Restriction negated() const {
+    vector<DomainInt> flipped;
+    for(DomainInt v : vals)
+      flipped.push_back(1 - v);
+    return Restriction(kind, flipped);
+  }
+
+  void apply(PresolveDomain& d) const {
+    switch(kind) {
+    case InSet: d.intersectSet(vals); break;
+    case NotInSet: d.removeSet(vals); break;
+    case InRange: d.intersectRange(vals[0], vals[1]); break;
+    case NotInRange: d.removeRange(vals[0], vals[1]); break;
+    }
+  }
+
+  // Is this true for every value in d?
+  bool entailed(const PresolveDomain& d) const {
+    switch(kind) {
+    case InSet:
+      if(d.size() > (DomainInt)vals.size())
+        return false;
+      if(d.sparse) {
+        for(DomainInt v : d.values)
+          if(!std::binary_search(vals.begin(), vals.end(), v))
+            return false;
+      } else {
+        for(DomainInt v = d.lower; v <= d.upper; ++v)
+          if(!std::binary_search(vals.begin(), vals.end(), v))
+            return false;
+      }
+      return true;
+    case NotInSet:
+      for(DomainInt v : vals)
+        if(d.contains(v))
+          return false;
+      return true;
+    case InRange: return vals[0] <= d.lower && d.upper <= vals[1];
+    case NotInRange:
+      if(d.sparse) {
+        for(DomainInt v : d.values)
+          if(vals[0] <= v && v <= vals[1])
+            return false;
+        return true;
+      }
+      return d.upper < vals[0] || d.lower > vals[1];
+    }
+    return false;
+  }
+};
+
+struct Presolver {
+  CSPInstance& instance;
+
+  // Domains of the variables presolve understands, indexed by variable
+  // (booleans without negation). Only those of representatives are kept
+  // up to date.
+  map<Var, PresolveDomain> domains;
+  map<Var, PresolveDomain> initialDomains;
+
+  // Union-find over merged variables. The flag is true when a boolean is
+  // the negation of its parent.
+  map<Var, pair<Var, bool>> parent;
+
+  SysInt merged;
+  SysInt removed;
+  bool changed;
+
+  Presolver(CSPInstance& _instance) : instance(_instance), merged(0), removed(0) {
+    const VarContainer& vars = instance.vars;
+    for(const Var& v : vars.getAllVars()) {
+      switch(v.type()) {
+      case VAR_BOOL: domains[v] = PresolveDomain(0, 1); break;
+      case VAR_BOUND:
+        domains[v] =
+            PresolveDomain(vars.bound[v.pos()].lowerBound, vars.bound[v.pos()].upperBound);
+        break;
+      case VAR_DISCRETE:
+        domains[v] =
+            PresolveDomain(vars.discrete[v.pos()].lowerBound, vars.discrete[v.pos()].upperBound);
+        break;
+      case VAR_SPARSEBOUND: domains[v] = PresolveDomain(vars.sparseBound[v.pos()]); break;
+      default: break;
+      }
+    }
+    initialDomains = domains;
+  }
+
+  // Splits v into a variable and whether it is negated.
+  static pair<Var, bool> split(Var v) {
+    if(v.type() == VAR_NOTBOOL)
+      return make_pair(Var(VAR_BOOL, v.pos()), true);
+    return make_pair(v, false);
+  }
+
+  static Var join(Var v, bool negated) {
+    return negated ? Var(VAR_NOTBOOL, v.pos()) : v;
+  }
+
+  pair<Var, bool> find(Var v) {
+    auto it = parent.find(v);
+    if(it == parent.end())
+      return make_pair(v, false);
+    pair<Var, bool> root = find(it->second.first);
+    root.second ^= it->second.second;
+    it->second = root;
+    return root;
+  }
+
+  // The variable v stands for once merged variables are replaced.
+  Var representative(Var v) {
+    pair<Var, bool> s = split(v);
+    if(domains.count(s.first) == 0)
+      return v;
+    pair<Var, bool> root = find(s.first);
+    return join(root.first, root.second ^ s.second);
+  }
+
+  // As representative, but fixed variables are replaced by constants.
+  Var image(Var v) {
+    Var r = representative(v);
+    pair<Var, bool> s = split(r);
+    auto it = domains.find(s.first);
+    if(it == domains.end() || !it->second.fixed())
+      return r;
+    DomainInt val = it->second.lower;
+    return Var(VAR_CONSTANT, s.second ? 1 - val : val);
+  }
+
+  // Restricts the domain of v. Returns true if the restriction is now
+  // entailed. Restrictions which would empty a domain are left to search.
+  bool restrict(Var v, const Restriction& r) {
+    if(v.type() == VAR_CONSTANT)
+      return r.entailed(PresolveDomain(v.pos(), v.pos()));
+    pair<Var, bool> s = split(v);
+    auto it = domains.find(s.first);
+    if(it == domains.end())
+      return false;
+    Restriction rs = s.second ? r.negated() : r;
+    PresolveDomain d = it->second;
+    rs.apply(d);
+    if(d.empty())
+      return false;
+    if(d != it->second) {
+      it->second = d;
+      changed = true;
+    }
+    return rs.entailed(d);
+  }
+
+  // Merges x and y, or x and not y if negated. Returns false if they
+  // cannot be merged.
+  bool unite(Var x, Var y, bool negated) {
+    pair<Var, bool> sx = split(x);
+    pair<Var, bool> sy = split(y);
+    if(domains.count(sx.first) == 0 || domains.count(sy.first) == 0)
+      return false;
+    negated ^= sx.second ^ sy.second;
+    Var a = sx.first;
+    Var b = sy.first;
+    if(a == b)
+      return !negated;
+
+    bool aBool = (a.type() == VAR_BOOL);
+    bool bBool = (b.type() == VAR_BOOL);
+    if(negated && !(aBool && bBool))
+      return false;
+    // Sparse bound variables cannot hold the holes of a discrete variable.
+    if((a.type() == VAR_SPARSEBOUND && b.type() == VAR_DISCRETE) ||
+       (a.type() == VAR_DISCRETE && b.type() == VAR_SPARSEBOUND))
+      return false;
+
+    // Keep the representation which propagates most: booleans, then
+    // discrete, then sparse bound, then bound variables.
+    auto rank = [](Var v) {
+      switch(v.type()) {
+      case VAR_BOOL: return 0;
+      case VAR_DISCRETE: return 1;
+      case VAR_SPARSEBOUND: return 2;
+      default: return 3;
+      }
+    };
+    if(rank(b) < rank(a) || (rank(b) == rank(a) && b < a))
+      std::swap(a, b);
+
+    PresolveDomain d = domains[a];
+    const PresolveDomain& other = domains[b];
+    if(negated) {
+      vector<DomainInt> allowed;
+      for(DomainInt v = 0; v <= 1; ++v)
+        if(other.contains(1 - v))
+          allowed.push_back(v);
+      d.intersectSet(allowed);
+    } else if(other.sparse) {
+      d.intersectSet(other.values);
+    } else {
+      d.intersectRange(other.lower, other.upper);
+    }
+    if(d.empty())
+      return false;
+
+    domains[a] = d;
+    parent[b] = make_pair(a, negated);
+    merged++;
+    changed = true;
+    return true;
+  }
+
+  void rewrite(ConstraintBlob& b) {
+    for(auto& list : b.vars)
+      for(auto& v : list)
+        v = image(v);
+    for(auto& c : b.internal_constraints)
+      rewrite(c);
+  }
+
+  static bool isConstant(Var v) {
+    return v.type() == VAR_CONSTANT;
+  }
+
+  // Simplifies a top level constraint. Returns true if it can be removed.
+  bool simplify(ConstraintBlob& c) {
+    switch(c.constraint->type) {
+    case CT_WATCHED_LIT:
+      return restrict(c.vars[0][0], Restriction(Restriction::InSet, {c.constants[0][0]}));
+    case CT_WATCHED_NOTLIT:
+      return restrict(c.vars[0][0], Restriction(Restriction::NotInSet, {c.constants[0][0]}));
+    case CT_WATCHED_INSET:
+      return restrict(c.vars[0][0], Restriction(Restriction::InSet, c.constants[0]));
+    case CT_WATCHED_NOT_INSET:
+      return restrict(c.vars[0][0], Restriction(Restriction::NotInSet, c.constants[0]));
+    case CT_WATCHED_INRANGE:
+      return restrict(c.vars[0][0], Restriction(Restriction::InRange, c.constants[0]));
+    case CT_WATCHED_NOT_INRANGE:
+      return restrict(c.vars[0][0], Restriction(Restriction::NotInRange, c.constants[0]));
+
+    case CT_EQ:
+    case CT_GACEQ:
+    case CT_DISEQ:
+    case CT_WATCHED_NEQ: {
+      bool equal = (c.constraint->type == CT_EQ || c.constraint->type == CT_GACEQ);
+      Var x = c.vars[0][0];
+      Var y = c.vars[1][0];
+      if(isConstant(x))
+        std::swap(x, y);
+      if(isConstant(y)) {
+        Restriction::Kind kind = equal ? Restriction::InSet : Restriction::NotInSet;
+        return restrict(x, Restriction(kind, {y.pos()}));
+      }
+      if(x == y)
+        return equal;
+      if(equal)
+        return unite(x, y, false);
+      if(x.type() == VAR_BOOL || x.type() == VAR_NOTBOOL)
+        if(y.type() == VAR_BOOL || y.type() == VAR_NOTBOOL)
+          return unite(x, y, true);
+      return false;
+    }
+
+    // x <= y + k
+    case CT_INEQ: {
+      Var x = c.vars[0][0];
+      Var y = c.vars[1][0];
+      DomainInt k = c.constants[0][0];
+      if(isConstant(y))
+        return restrict(x, Restriction(Restriction::InRange,
+                                       {DomainInt_Min, DomainInt(y.pos()) + k}));
+      if(isConstant(x))
+        return restrict(y, Restriction(Restriction::InRange,
+                                       {DomainInt(x.pos()) - k, DomainInt_Max}));
+      return x == y && k >= 0;
+    }
+
+    case CT_TRUE: return true;
+
+    default: return false;
+    }
+  }
+
+  // Replaces reify and reifyimply of a constant by the constraint itself,
+  // or nothing. Returns true if c should be removed.
+  bool foldReify(ConstraintBlob& c) {
+    ConstraintType type = c.constraint->type;
+    if(type != CT_REIFY && type != CT_REIFYIMPLY && type != CT_REIFYIMPLY_QUICK)
+      return false;
+    Var r = c.vars[0][0];
+    if(!isConstant(r))
+      return false;
+    if(r.pos() == 1) {
+      ConstraintBlob inner = c.internal_constraints[0];
+      c = inner;
+      changed = true;
+      return false;
+    }
+    if(r.pos() == 0 && type != CT_REIFY)
+      return true;
+    return false;
+  }
+
+  // A description of c, without the final constant of constraints whose
+  // strength depends only on it. That constant is returned in bound, and
+  // is an upper limit if upper is true.
+  static string key(const ConstraintBlob& c, bool& hasBound, DomainInt& bound, bool& upper) {
+    ConstraintType type = c.constraint->type;
+    vector<vector<Var>> vars = c.vars;
+    vector<vector<DomainInt>> constants = c.constants;
+    hasBound = false;
+
+    switch(type) {
+    case CT_EQ:
+    case CT_GACEQ:
+    case CT_DISEQ:
+    case CT_WATCHED_NEQ:
+      if(vars[1][0] < vars[0][0])
+        std::swap(vars[0], vars[1]);
+      break;
+    case CT_INEQ:
+    case CT_WATCHED_LEQSUM:
+    case CT_WATCHED_GEQSUM:
+      hasBound = true;
+      upper = (type != CT_WATCHED_GEQSUM);
+      bound = constants.back()[0];
+      constants.pop_back();
+      break;
+    case CT_LEQSUM:
+    case CT_GEQSUM:
+    case CT_WEIGHTLEQSUM:
+    case CT_WEIGHTGEQSUM:
+      if(isConstant(vars.back()[0])) {
+        hasBound = true;
+        upper = (type == CT_LEQSUM || type == CT_WEIGHTLEQSUM);
+        bound = vars.back()[0].pos();
+        vars.pop_back();
+      }
+      break;
+    default: break;
+    }
+
+    ostringstream o;
+    o << c.constraint->name << "(";
+    for(const auto& list : vars) {
+      o << "[";
+      for(const auto& v : list)
+        o << v.get_name() << ",";
+      o << "]";
+    }
+    for(const auto& list : constants) {
+      o << "{";
+      for(const auto& v : list)
+        o << v << ",";
+      o << "}";
+    }
+    for(const auto& v : c.negs)
+      o << v << ",";
+    o << (void*)c.tuples << "," << (void*)c.tuples2 << "," << (void*)c.shortTuples << ","
+      << (void*)c.smartTuples << "," << (void*)c.gadget.get();
+    for(const auto& inner : c.internal_constraints) {
+      bool b;
+      DomainInt d;
+      bool u;
+      o << key(inner, b, d, u);
+      if(b)
+        o << d;
+    }
+    o << ")";
+    return o.str();
+  }
+
+  // Removes constraints which are the same as, or weaker than, another one.
+  void removeDuplicates() {
+    map<string, list<ConstraintBlob>::iterator> seen;
+    for(auto it = instance.constraints.begin(); it != instance.constraints.end();) {
+      bool hasBound;
+      DomainInt bound;
+      bool upper;
+      string k = key(*it, hasBound, bound, upper);
+      auto prev = seen.find(k);
+      if(prev == seen.end()) {
+        seen[k] = it;
+        ++it;
+        continue;
+      }
+      if(hasBound) {
+        bool dummy;
+        DomainInt prevBound;
+        key(*prev->second, dummy, prevBound, dummy);
+        if(upper ? bound < prevBound : bound > prevBound) {
+          // The new constraint is tighter, so keep it instead.
+          instance.constraints.erase(prev->second);
+          prev->second = it;
+          ++it;
+          removed++;
+          continue;
+        }
+      }
+      it = instance.constraints.erase(it);
+      removed++;
+    }
+  }
+
+  // Replaces variables by their representatives, outside of constraints.
+  void rewriteVarLists() {
+    for(auto& order : instance.searchOrder) {
+      set<Var> present;
+      vector<Var> vars;
+      vector<ValOrder> vals;
+      for(SysInt i = 0; i < (SysInt)order.varOrder.size(); ++i) {
+        Var v = split(representative(order.varOrder[i])).first;
+        if(present.insert(v).second) {
+          vars.push_back(v);
+          if(i < (SysInt)order.valOrder.size())
+            vals.push_back(order.valOrder[i]);
+        }
+      }
+      order.varOrder = vars;
+      if(!order.valOrder.empty())
+        order.valOrder = vals;
+    }
+
+    for(auto& row : instance.print_matrix)
+      for(auto& v : row)
+        v = representative(v);
+    for(auto& v : instance.optimiseVariables)
+      v = representative(v);
+    for(auto& v : instance.symOrder)
+      v = representative(v);
+  }
+
+  // Writes the new domains back into the instance. Booleans cannot be
+  // given a smaller domain, so fixed booleans get a literal constraint.
+  SysInt writeDomains(SysInt& fixed) {
+    SysInt tightened = 0;
+    fixed = 0;
+    for(auto& p : domains) {
+      const Var& v = p.first;
+      const PresolveDomain& d = p.second;
+      if(parent.count(v) != 0 || d == initialDomains[v])
+        continue;
+      tightened++;
+      if(d.fixed())
+        fixed++;
+      switch(v.type()) {
+      case VAR_BOOL:
+        if(d.fixed()) {
+          ConstraintBlob lit(get_constraint(CT_WATCHED_LIT), makeVec(makeVec(v)));
+          lit.constants.push_back(makeVec(d.lower));
+          instance.add_constraint(lit);
+          removed--;
+        }
+        break;
+      case VAR_BOUND: instance.vars.bound[v.pos()] = Bounds(d.lower, d.upper); break;
+      case VAR_DISCRETE: instance.vars.discrete[v.pos()] = Bounds(d.lower, d.upper); break;
+      case VAR_SPARSEBOUND: instance.vars.sparseBound[v.pos()] = d.values; break;
+      default: D_FATAL_ERROR("Internal error");
+      }
+    }
+    return tightened;
+  }
+
+  void run() {
+    do {
+      changed = false;
+      for(auto it = instance.constraints.begin(); it != instance.constraints.end();) {
+        rewrite(*it);
+        if(foldReify(*it) || simplify(*it)) {
+          it = instance.constraints.erase(it);
+          removed++;
+          changed = true;
+        } else {
+          ++it;
+        }
+      }
+    } while(changed);
+
+    removeDuplicates();
+    rewriteVarLists();
+
+    SysInt fixed;
+    SysInt tightened = writeDomains(fixed);
+
+    getOptions().printLine("Presolve removed " + tostring(removed) + " constraints, merged " +
+                           tostring(merged) + " variables and fixed " + tostring(fixed) +
+                           " variables");
+    getTableOut().set("PresolveConstraintsRemoved", tostring(removed));
+    getTableOut().set("PresolveVariablesMerged", tostring(merged));
+    getTableOut().set("PresolveVariablesFixed", tostring(fixed));
+    getTableOut().set("PresolveDomainsTightened", tostring(tightened));
+  }
+};
+} // namespace
+
+void presolveInstance(CSPInstance& instance) {
+  Presolver p(instance);
+  p.run();
+}
@@ -0,0 +1,34 @@
+/*
+ * Minion http://minion.sourceforge.net
+ * Copyright (C) 2006-09
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+#ifndef PRESOLVE_H
+#define PRESOLVE_H
+
+#include "minion.h"
+
+#include "inputfile_parse/inputfile_parse.h"
+
+/// Simplifies instance before any constraint is built (-presolve).
+/// Unary constraints are moved into the initial domains, fixed variables
+/// are replaced by constants, variables joined by eq are merged into one,
+/// and duplicated, subsumed or entailed constraints are removed.
+void presolveInstance(CSPInstance& instance);
+
+#endif
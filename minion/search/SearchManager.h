@@ -23,6 +23,7 @@
 
 #include "../preprocess.h"
 #include "common_search.h"
+#include "symmetry_nogoods.h"
 #include "variable_orderings.h"
 
 namespace Controller {
@@ -61,6 +62,11 @@ struct StandardSearchManager : public SearchManager {
 
   vector<Controller::triple> branches; // L & R branches so far (isLeftBranch?,var,value)
 
+  // Symmetry breaking nogoods for -symmetry-dynamic, or NULL.
+  shared_ptr<SymmetryNogoods> symmetry;
+  // Branches made above this search, which reset() has forgotten.
+  vector<Controller::triple> prefix;
+
   StandardSearchManager(
       shared_ptr<VariableOrder> _varOrder, shared_ptr<Propagate> _prop,
       std::function<void(const vector<AnyVarRef>&, const vector<Controller::triple>&)> _check_func,
@@ -75,6 +81,7 @@ struct StandardSearchManager : public SearchManager {
   }
 
   void reset() {
+    prefix.insert(prefix.end(), branches.begin(), branches.end());
     branches.clear();
   }
 
@@ -125,6 +132,8 @@ struct StandardSearchManager : public SearchManager {
       varArray[var].removeFromDomain(val);
     }
     maybe_print_search_assignment(varArray[var], val, false);
+    if(symmetry && !stolen && !getState().isFailed())
+      symmetry->refuted(prefix, branches, var, val);
     branches.push_back(Controller::triple(false, var, val));
 
     // If this branch was stolen, then we want to carry on
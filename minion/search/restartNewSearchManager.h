@@ -46,6 +46,7 @@ struct RestartNewSearchManager : public Controller::SearchManager {
 
     sm = make_shared<Controller::StandardSearchManager>(vo, prop, timeoutChecker, solutionHandler,
                                                         optimisationHandler);
+    sm->symmetry = make_symmetry_nogoods(order);
 
     try {
       sm->search();
@@ -105,6 +105,29 @@ shared_ptr<Propagate> make_propagator(PropagationLevel propMethod) {
   return p;
 }
 
+// Builds the symmetry breaking nogoods for -symmetry-dynamic, for a search
+// over the variables of order.
+shared_ptr<SymmetryNogoods> make_symmetry_nogoods(const vector<SearchOrder>& order) {
+  ::ProbSpec::CSPInstance* instance = getState().getInstance();
+  if(getOptions().symmetryBreak != SB_Dynamic || instance->symmetryGenerators.empty())
+    return shared_ptr<SymmetryNogoods>();
+
+  map<Var, SysInt> position;
+  for(SysInt i = 0; i < (SysInt)instance->symOrder.size(); ++i)
+    position[instance->symOrder[i]] = i;
+
+  vector<SysInt> searchToVar;
+  for(const auto& o : order)
+    for(const auto& v : o.varOrder)
+      searchToVar.push_back(position.count(v) ? position[v] : -1);
+
+  shared_ptr<SymmetryNogoods> sn(new SymmetryNogoods(
+      getAnyVarRefFromVar(instance->symOrder), instance->symmetryGenerators, searchToVar));
+  sn->setup();
+  sn->fullPropagateDone = true;
+  return sn;
+}
+
 // returns an instance of SearchManager with the required variable ordering,
 // propagator etc.
 shared_ptr<SearchManager> makeSearch_manager(PropagationLevel propMethod,
@@ -134,8 +157,9 @@ shared_ptr<SearchManager> makeSearch_manager(PropagationLevel propMethod,
   }
 
   // need to switch here for different search algorthms. plain, parallel, group
-  shared_ptr<SearchManager> sm(new StandardSearchManager(vo, p, standardTime_ctrlc_checks,
-                                                         standard_dealWith_solution, opt_handler));
+  shared_ptr<StandardSearchManager> sm(new StandardSearchManager(
+      vo, p, standardTime_ctrlc_checks, standard_dealWith_solution, opt_handler));
+  sm->symmetry = make_symmetry_nogoods(order);
 
   return sm;
 }
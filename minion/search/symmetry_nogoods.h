@@ -0,0 +1,220 @@
+/*
+ * Minion http://minion.sourceforge.net
+ * Copyright (C) 2006-09
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+#ifndef SYMMETRY_NOGOODS_H
+#define SYMMETRY_NOGOODS_H
+
+#include "common_search.h"
+
+// Symmetry breaking during search, in the style of SBDS.
+//
+// When search refutes a decision x = a, having made decisions A above it,
+// every solution under A /\ x = a has been found. So for each symmetry g,
+// we can post g(A) -> g(x) != a for the rest of the search below A.
+// These nogoods live in a stack whose size is backtracked, so they vanish
+// when search backtracks above the node they were posted at.
+//
+// Only the given symmetries (usually generators and their inverses) are
+// used, so not all symmetric solutions are removed, but no solution is
+// removed unless a symmetric one has been found.
+//
+// This is not added to the list of constraints: it is set up and triggered
+// directly, so it is never checked or counted against the variables.
+struct SymmetryNogoods : public AbstractConstraint {
+  struct Literal {
+    SysInt var;
+    DomainInt val;
+    bool equal;
+  };
+
+  struct Nogood {
+    vector<Literal> condition;
+    SysInt var;
+    DomainInt val;
+    long long serial;
+  };
+
+  vector<AnyVarRef> vars;
+  vector<vector<SysInt>> symmetries;
+  // Position in vars of each search variable, or -1.
+  vector<SysInt> searchToVar;
+
+  vector<Nogood> nogoods;
+  Reversible<SysInt> nogoodCount;
+  long long serial;
+
+  // Nogoods (and their serials) whose condition mentions each variable.
+  vector<vector<pair<SysInt, long long>>> occurs;
+  vector<char> watched;
+
+  SymmetryNogoods(const vector<AnyVarRef>& _vars, const vector<vector<SysInt>>& generators,
+                  const vector<SysInt>& _searchToVar)
+      : vars(_vars),
+        searchToVar(_searchToVar),
+        nogoodCount(0),
+        serial(0),
+        occurs(_vars.size()),
+        watched(_vars.size(), 0) {
+    for(const auto& g : generators) {
+      symmetries.push_back(g);
+      vector<SysInt> inverse(g.size());
+      for(SysInt i = 0; i < (SysInt)g.size(); ++i)
+        inverse[g[i]] = i;
+      if(inverse != g)
+        symmetries.push_back(inverse);
+    }
+  }
+
+  virtual string constraintName() {
+    return "symmetrynogoods";
+  }
+
+  CONSTRAINT_ARG_LIST1(vars);
+
+  SysInt dynamicTriggerCount() {
+    return vars.size();
+  }
+
+  // 1 if the literal is true, 0 if false, -1 if not yet known.
+  SysInt status(const Literal& l) {
+    const AnyVarRef& v = vars[l.var];
+    if(!v.inDomain(l.val))
+      return l.equal ? 0 : 1;
+    if(v.isAssigned())
+      return l.equal ? 1 : 0;
+    return -1;
+  }
+
+  // Removes val from var if possible. Values inside the bounds of a bound
+  // variable cannot be removed, so those nogoods are never stored.
+  static bool canRemove(const AnyVarRef& v, DomainInt val) {
+    return !v.isBound() || v.min() == val || v.max() == val;
+  }
+
+  static void remove(AnyVarRef& v, DomainInt val) {
+    if(v.min() == val)
+      v.setMin(val + 1);
+    else if(v.max() == val)
+      v.setMax(val - 1);
+    else
+      v.removeFromDomain(val);
+  }
+
+  /// Posts the symmetric images of the refuted decision var = val, made
+  /// below the given decisions.
+  void refuted(const vector<Controller::triple>& prefix, const vector<Controller::triple>& branches,
+               SysInt searchVar, DomainInt val) {
+    SysInt x = searchToVar[searchVar];
+    if(x == -1)
+      return;
+    vector<Literal> decisions;
+    for(const auto* list : {&prefix, &branches})
+      for(const auto& t : *list) {
+        SysInt v = searchToVar[t.var];
+        if(v == -1)
+          return;
+        decisions.push_back(Literal{v, t.val, t.isLeft});
+      }
+
+    for(const auto& g : symmetries) {
+      AnyVarRef& target = vars[g[x]];
+      if(!target.inDomain(val) || !canRemove(target, val))
+        continue;
+
+      // Literals which are already true stay true below here, and if any
+      // is false the nogood can never fire, so only unknown ones are kept.
+      Nogood n;
+      bool dead = false;
+      for(const auto& d : decisions) {
+        Literal l{g[d.var], d.val, d.equal};
+        SysInt s = status(l);
+        if(s == 0) {
+          dead = true;
+          break;
+        }
+        if(s == -1)
+          n.condition.push_back(l);
+      }
+      if(dead)
+        continue;
+
+      if(n.condition.empty()) {
+        remove(target, val);
+        if(getState().isFailed())
+          return;
+        continue;
+      }
+
+      n.var = g[x];
+      n.val = val;
+      n.serial = ++serial;
+      SysInt id = nogoodCount;
+      nogoods.resize(id);
+      nogoods.push_back(std::move(n));
+      nogoodCount = id + 1;
+      for(const auto& l : nogoods.back().condition) {
+        occurs[l.var].push_back(make_pair(id, serial));
+        if(!watched[l.var]) {
+          watched[l.var] = 1;
+          moveTriggerInt(vars[l.var], l.var, DomainChanged);
+        }
+      }
+    }
+  }
+
+  virtual void propagateDynInt(SysInt trig, DomainDelta) {
+    SysInt count = nogoodCount;
+    vector<pair<SysInt, long long>>& list = occurs[trig];
+    for(SysInt i = 0; i < (SysInt)list.size(); ++i) {
+      SysInt id = list[i].first;
+      if(id >= count || nogoods[id].serial != list[i].second) {
+        // Backtracked away, so this will never be needed again.
+        list[i] = list.back();
+        list.pop_back();
+        --i;
+        continue;
+      }
+      Nogood& n = nogoods[id];
+      bool fire = true;
+      for(const auto& l : n.condition)
+        if(status(l) != 1) {
+          fire = false;
+          break;
+        }
+      if(fire && vars[n.var].inDomain(n.val)) {
+        remove(vars[n.var], n.val);
+        if(getState().isFailed())
+          return;
+      }
+    }
+  }
+
+  virtual void fullPropagate() {}
+
+  virtual BOOL checkAssignment(DomainInt* v, SysInt arraySize) {
+    return true;
+  }
+
+  virtual vector<AnyVarRef> getVars() {
+    return vars;
+  }
+};
+
+#endif
@@ -0,0 +1,302 @@
+/*
+ * Minion http://minion.sourceforge.net
+ * Copyright (C) 2006-09
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+#ifndef _SMART_TUPLE_CONTAINER_H
+#define _SMART_TUPLE_CONTAINER_H
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+// This file contains smart tuples, as used by smarttable. A smart tuple is a
+// conjunction of conditions, each of which is either unary (x3 <= 7,
+// x1 in {2,4..6}) or a binary relation between two variables (x0 < x2).
+// Variables without any condition may take any value.
+
+enum SmartRelation { SMART_EQ, SMART_NEQ, SMART_LT, SMART_LEQ };
+
+/// All the unary conditions on one variable of a smart tuple, merged together.
+/// The variable must be in [lower, upper]. If hasSet, it must also be in
+/// 'allowed', otherwise it must not be in 'forbidden'.
+struct SmartVarCondition {
+  SysInt var;
+  DomainInt lower;
+  DomainInt upper;
+  bool hasSet;
+  vector<DomainInt> allowed;   // sorted
+  vector<DomainInt> forbidden; // sorted, always empty if hasSet
+
+  SmartVarCondition(SysInt _var)
+      : var(_var), lower(DomainInt_Min), upper(DomainInt_Max), hasSet(false) {}
+
+  bool contains(DomainInt val) const {
+    if(val < lower || val > upper)
+      return false;
+    if(hasSet)
+      return std::binary_search(allowed.begin(), allowed.end(), val);
+    return !std::binary_search(forbidden.begin(), forbidden.end(), val);
+  }
+
+  void restrictBounds(DomainInt lo, DomainInt hi) {
+    lower = std::max(lower, lo);
+    upper = std::min(upper, hi);
+  }
+
+  /// 'vals' must be sorted, with no duplicates.
+  void restrictToSet(const vector<DomainInt>& vals) {
+    if(!hasSet) {
+      hasSet = true;
+      allowed = vals;
+      return;
+    }
+    vector<DomainInt> both;
+    std::set_intersection(allowed.begin(), allowed.end(), vals.begin(), vals.end(),
+                          std::back_inserter(both));
+    allowed.swap(both);
+  }
+
+  /// 'vals' must be sorted, with no duplicates.
+  void forbid(const vector<DomainInt>& vals) {
+    vector<DomainInt> both;
+    std::set_union(forbidden.begin(), forbidden.end(), vals.begin(), vals.end(),
+                   std::back_inserter(both));
+    forbidden.swap(both);
+  }
+
+  /// Puts the condition in a canonical form, where 'allowed' and 'forbidden'
+  /// only contain values inside the bounds, and the bounds are tight.
+  /// Returns false if no value satisfies the condition.
+  bool normalise() {
+    if(hasSet) {
+      vector<DomainInt> vals;
+      for(SysInt i = 0; i < (SysInt)allowed.size(); ++i) {
+        if(contains(allowed[i]) &&
+           !std::binary_search(forbidden.begin(), forbidden.end(), allowed[i]))
+          vals.push_back(allowed[i]);
+      }
+      allowed.swap(vals);
+      forbidden.clear();
+      if(allowed.empty())
+        return false;
+      lower = allowed.front();
+      upper = allowed.back();
+      return true;
+    }
+
+    if(lower > upper)
+      return false;
+    vector<DomainInt>::iterator begin =
+        std::lower_bound(forbidden.begin(), forbidden.end(), lower);
+    vector<DomainInt>::iterator end = std::upper_bound(begin, forbidden.end(), upper);
+    forbidden = vector<DomainInt>(begin, end);
+    while(lower <= upper && std::binary_search(forbidden.begin(), forbidden.end(), lower))
+      lower++;
+    while(lower <= upper && std::binary_search(forbidden.begin(), forbidden.end(), upper))
+      upper--;
+    return lower <= upper;
+  }
+};
+
+/// The binary condition 'vars[first] rel vars[second]' of a smart tuple,
+/// where first and second are positions in SmartTuple::vars.
+struct SmartBinaryCondition {
+  SysInt first;
+  SmartRelation rel;
+  SysInt second;
+
+  SmartBinaryCondition(SysInt _first, SmartRelation _rel, SysInt _second)
+      : first(_first), rel(_rel), second(_second) {}
+
+  bool holds(DomainInt x, DomainInt y) const {
+    switch(rel) {
+    case SMART_EQ: return x == y;
+    case SMART_NEQ: return x != y;
+    case SMART_LT: return x < y;
+    case SMART_LEQ: return x <= y;
+    }
+    abort();
+  }
+};
+
+struct SmartTuple {
+  /// One entry for every variable mentioned in the tuple, each variable at
+  /// most once.
+  vector<SmartVarCondition> vars;
+  /// Each variable is in at most one binary condition.
+  vector<SmartBinaryCondition> binary;
+
+  /// Returns the position of 'var' in 'vars', adding it if it is not there.
+  SysInt getVar(SysInt var) {
+    for(SysInt i = 0; i < (SysInt)vars.size(); ++i) {
+      if(vars[i].var == var)
+        return i;
+    }
+    vars.push_back(SmartVarCondition(var));
+    return vars.size() - 1;
+  }
+
+  /// Checks if a complete assignment satisfies the tuple.
+  bool check(const DomainInt* v) const {
+    for(SysInt i = 0; i < (SysInt)vars.size(); ++i) {
+      if(!vars[i].contains(v[vars[i].var]))
+        return false;
+    }
+    for(SysInt i = 0; i < (SysInt)binary.size(); ++i) {
+      if(!binary[i].holds(v[vars[binary[i].first].var], v[vars[binary[i].second].var]))
+        return false;
+    }
+    return true;
+  }
+};
+
+class SmartTupleList {
+  vector<SmartTuple> tuples;
+  SysInt maxVarsInTuple;
+  SysInt maxVarIndex;
+  string tuple_name;
+
+  static void printSet(std::ostream& o, const vector<DomainInt>& vals) {
+    o << "{";
+    for(SysInt i = 0; i < (SysInt)vals.size(); ++i) {
+      if(i > 0)
+        o << ",";
+      SysInt j = i;
+      while(j + 1 < (SysInt)vals.size() && vals[j + 1] == vals[j] + 1)
+        j++;
+      if(j >= i + 2) {
+        o << vals[i] << ".." << vals[j];
+        i = j;
+      } else
+        o << vals[i];
+    }
+    o << "}";
+  }
+
+public:
+  SmartTupleList(const vector<SmartTuple>& _tuples)
+      : tuples(_tuples), maxVarsInTuple(0), maxVarIndex(-1) {
+    for(SysInt i = 0; i < (SysInt)tuples.size(); ++i) {
+      maxVarsInTuple = std::max(maxVarsInTuple, (SysInt)tuples[i].vars.size());
+      for(SysInt j = 0; j < (SysInt)tuples[i].vars.size(); ++j)
+        maxVarIndex = std::max(maxVarIndex, tuples[i].vars[j].var);
+    }
+  }
+
+  void setName(string name) {
+    tuple_name = name;
+  }
+
+  string getName() const {
+    return tuple_name;
+  }
+
+  SysInt size() const {
+    return tuples.size();
+  }
+
+  const SmartTuple& operator[](SysInt i) const {
+    return tuples[i];
+  }
+
+  /// The largest number of variables mentioned by any one tuple.
+  SysInt maxVars() const {
+    return maxVarsInTuple;
+  }
+
+  /// The largest variable index mentioned by any tuple, or -1 if none.
+  SysInt maxVar() const {
+    return maxVarIndex;
+  }
+
+  /// Prints tuple 'i', in the format read by the parser.
+  void printTuple(std::ostream& o, SysInt i) const {
+    const SmartTuple& tup = tuples[i];
+    o << "[";
+    bool first = true;
+    for(SysInt j = 0; j < (SysInt)tup.vars.size(); ++j) {
+      const SmartVarCondition& c = tup.vars[j];
+      if(c.hasSet) {
+        o << (first ? "" : ", ") << "(x" << c.var;
+        if(c.allowed.size() == 1)
+          o << " = " << c.allowed[0];
+        else {
+          o << " in ";
+          printSet(o, c.allowed);
+        }
+        o << ")";
+        first = false;
+        continue;
+      }
+      if(c.lower == c.upper) {
+        o << (first ? "" : ", ") << "(x" << c.var << " = " << c.lower << ")";
+        first = false;
+        continue;
+      }
+      if(c.lower != DomainInt_Min) {
+        o << (first ? "" : ", ") << "(x" << c.var << " >= " << c.lower << ")";
+        first = false;
+      }
+      if(c.upper != DomainInt_Max) {
+        o << (first ? "" : ", ") << "(x" << c.var << " <= " << c.upper << ")";
+        first = false;
+      }
+      if(!c.forbidden.empty()) {
+        o << (first ? "" : ", ") << "(x" << c.var;
+        if(c.forbidden.size() == 1)
+          o << " != " << c.forbidden[0];
+        else {
+          o << " notin ";
+          printSet(o, c.forbidden);
+        }
+        o << ")";
+        first = false;
+      }
+    }
+    for(SysInt j = 0; j < (SysInt)tup.binary.size(); ++j) {
+      const SmartBinaryCondition& b = tup.binary[j];
+      const char* relnames[] = {" = ", " != ", " < ", " <= "};
+      o << (first ? "" : ", ") << "(x" << tup.vars[b.first].var << relnames[b.rel] << "x"
+        << tup.vars[b.second].var << ")";
+      first = false;
+    }
+    o << "]";
+  }
+};
+
+class SmartTupleListContainer {
+  std::vector<SmartTupleList*> InternalTupleList;
+
+public:
+  SmartTupleList* getNewSmartTupleList(const vector<SmartTuple>& tuples) {
+    SmartTupleList* tuplelistPtr = new SmartTupleList(tuples);
+    InternalTupleList.push_back(tuplelistPtr);
+    return tuplelistPtr;
+  }
+
+  SmartTupleList* getSmartTupleList(DomainInt num) {
+    return InternalTupleList[checked_cast<SysInt>(num)];
+  }
+
+  SysInt size() {
+    return InternalTupleList.size();
+  }
+};
+
+#endif
@@ -69,6 +69,7 @@ class SearchState {
 
   shared_ptr<TupleListContainer> tupleListContainer;
   shared_ptr<ShortTupleListContainer> shortTupleListContainer;
+  shared_ptr<SmartTupleListContainer> smartTupleListContainer;
 
   volatile bool alarmTrigger;
 
@@ -206,6 +207,9 @@ public:
   ShortTupleListContainer* getShortTupleListContainer() {
     return &*shortTupleListContainer;
   }
+  SmartTupleListContainer* getSmartTupleListContainer() {
+    return &*smartTupleListContainer;
+  }
 
   void setTupleListContainer(shared_ptr<TupleListContainer> _tupleList) {
     tupleListContainer = _tupleList;
@@ -215,6 +219,10 @@ public:
     shortTupleListContainer = _tupleList;
   }
 
+  void setSmartTupleListContainer(shared_ptr<SmartTupleListContainer> _tupleList) {
+    smartTupleListContainer = _tupleList;
+  }
+
   SearchState()
       : nodes(0),
         backtracks(0),
@@ -325,9 +333,23 @@ public:
   int parallelcores = 0;
   bool parallelStealHigh = true;
 
+  // Number of processes used by SAC and SSAC preprocessing.
+  int preprocessCores = 1;
+
   // Gather AMOs
   bool gatherAMOs = false;
 
+  // Detect symmetries, and break them with lex constraints or during search.
+  SymmetryBreak symmetryBreak = SB_None;
+
+  // Simplify the instance before building constraints.
+  bool presolve = false;
+
+  // Build every variable with the representation it was declared with,
+  // rather than storing DISCRETE variables which only need their bounds as
+  // BOUND.
+  bool keepVarTypes = false;
+
   // How (if at all) to autogenerate short tuples from long ones.
   MapLongTuplesToShort map_long_short;
 
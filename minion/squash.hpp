@@ -1,99 +1,306 @@
 
+#include <algorithm>
+#include <atomic>
 #include <limits>
 #include <numeric>
 #include <set>
+#include <thread>
 #include <vector>
 
 static const DomainInt freeValue = std::numeric_limits<SysInt>::max();
 
 typedef std::vector<DomainInt> Vint;
 
-template <typename TupleCon>
-std::pair<std::set<Vint>, std::set<Vint>>
-squeeze_tuples(const TupleCon& tuples, const std::vector<std::set<DomainInt>>& domains,
-               bool eager_prune) {
-  std::set<Vint> used_tuples;
-  std::set<Vint> ret_tuples;
-  for(typename TupleCon::iterator it = tuples.begin(); it != tuples.end(); ++it) {
-    const std::vector<DomainInt>& tuple = *it;
-    if(!eager_prune || used_tuples.count(tuple) == 0) {
-      for(SysInt i = 0; i < (SysInt)domains.size(); ++i) {
-        if(used_tuples.count(tuple) > 0 && eager_prune)
-          break;
-
-        if(tuple[i] == freeValue)
+// The squash pipeline works on tuples stored in one flat array, sorted
+// lexicographically (the same order as a std::set<Vint>) and with no
+// duplicates. This avoids an allocation per tuple, and instead of looking up
+// copies of tuples one value at a time, tuples which differ in only one
+// position are found by sorting and grouping runs.
+class FlatTuples {
+  SysInt arity;
+  SysInt count;
+  std::vector<DomainInt> data;
+
+public:
+  FlatTuples(SysInt _arity) : arity(_arity), count(0) {}
+
+  SysInt tupleSize() const {
+    return arity;
+  }
+
+  SysInt size() const {
+    return count;
+  }
+
+  bool empty() const {
+    return count == 0;
+  }
+
+  const DomainInt* operator[](SysInt pos) const {
+    D_ASSERT(pos >= 0 && pos < count);
+    return data.data() + (size_t)pos * arity;
+  }
+
+  void reserve(SysInt tuples) {
+    data.reserve((size_t)tuples * arity);
+  }
+
+  void push_back(const DomainInt* tuple) {
+    data.insert(data.end(), tuple, tuple + arity);
+    count++;
+  }
+
+  void append(const FlatTuples& other) {
+    D_ASSERT(other.arity == arity);
+    data.insert(data.end(), other.data.begin(), other.data.end());
+    count += other.count;
+  }
+
+  /// Sort tuples lexicographically and remove duplicates.
+  void sortAndUnique() {
+    std::vector<SysInt> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    const DomainInt* base = data.data();
+    const SysInt len = arity;
+    std::sort(order.begin(), order.end(), [base, len](SysInt a, SysInt b) {
+      return std::lexicographical_compare(base + (size_t)a * len, base + (size_t)(a + 1) * len,
+                                          base + (size_t)b * len, base + (size_t)(b + 1) * len);
+    });
+
+    std::vector<DomainInt> sorted;
+    sorted.reserve(data.size());
+    SysInt newCount = 0;
+    for(SysInt i = 0; i < count; ++i) {
+      const DomainInt* t = base + (size_t)order[i] * len;
+      if(newCount > 0 && std::equal(t, t + len, sorted.end() - len))
+        continue;
+      sorted.insert(sorted.end(), t, t + len);
+      newCount++;
+    }
+    data.swap(sorted);
+    count = newCount;
+  }
+};
+
+// For one position of a list of tuples, the sets of tuples which are equal
+// everywhere except that position, and between them contain every value in
+// the domain of that position. Such a set can be replaced by a single tuple
+// with 'freeValue' at that position. Every group has exactly 'groupSize'
+// members, group g is stored in members[g*groupSize .. (g+1)*groupSize).
+struct SqueezeGroups {
+  SysInt groupSize;
+  /// For each tuple, the group it is in, or -1.
+  std::vector<SysInt> groupOf;
+  std::vector<SysInt> members;
+  /// Number of members of each group used by an earlier squeeze (eager mode).
+  std::vector<SysInt> usedCount;
+
+  SysInt groupCount() const {
+    return usedCount.size();
+  }
+
+  const SysInt* group(SysInt g) const {
+    return members.data() + (size_t)g * groupSize;
+  }
+};
+
+inline void findSqueezeGroups(const FlatTuples& tuples, SysInt pos, SysInt domSize,
+                              SqueezeGroups& groups) {
+  const SysInt arity = tuples.tupleSize();
+  groups.groupSize = domSize;
+  groups.groupOf.assign(tuples.size(), -1);
+  groups.members.clear();
+  groups.usedCount.clear();
+
+  if(domSize == 0)
+    return;
+
+  std::vector<SysInt> order;
+  order.reserve(tuples.size());
+  for(SysInt i = 0; i < tuples.size(); ++i) {
+    if(tuples[i][pos] != freeValue)
+      order.push_back(i);
+  }
+
+  // Compare tuples ignoring 'pos'. The sort is stable so each run stays in
+  // the original (lexicographic) order.
+  auto keyCompare = [&tuples, pos, arity](SysInt a, SysInt b) {
+    const DomainInt* ta = tuples[a];
+    const DomainInt* tb = tuples[b];
+    for(SysInt i = 0; i < arity; ++i) {
+      if(i != pos && ta[i] != tb[i])
+        return ta[i] < tb[i];
+    }
+    return false;
+  };
+
+  // Tuples are already sorted, so when 'pos' is the last position the runs
+  // are already contiguous.
+  if(pos != arity - 1)
+    std::stable_sort(order.begin(), order.end(), keyCompare);
+
+  size_t runStart = 0;
+  while(runStart < order.size()) {
+    size_t runEnd = runStart + 1;
+    while(runEnd < order.size() && !keyCompare(order[runStart], order[runEnd]))
+      runEnd++;
+    // Tuples in a run are distinct, and only differ at 'pos', so a run covers
+    // the whole domain exactly when it is the size of the domain.
+    if((SysInt)(runEnd - runStart) == domSize) {
+      SysInt g = groups.usedCount.size();
+      groups.usedCount.push_back(0);
+      for(size_t i = runStart; i < runEnd; ++i) {
+        groups.groupOf[order[i]] = g;
+        groups.members.push_back(order[i]);
+      }
+    }
+    runStart = runEnd;
+  }
+}
+
+// Below this many values, building the groups is not worth starting threads.
+static const size_t squashThreadThreshold = 1 << 16;
+
+inline std::vector<SqueezeGroups> findAllSqueezeGroups(const FlatTuples& tuples,
+                                                       const std::vector<SysInt>& domSizes) {
+  const SysInt arity = tuples.tupleSize();
+  std::vector<SqueezeGroups> groups(arity);
+
+  SysInt threads = std::thread::hardware_concurrency();
+  if((size_t)tuples.size() * arity < squashThreadThreshold)
+    threads = 1;
+  threads = std::max<SysInt>(1, std::min(threads, arity));
+
+  if(threads == 1) {
+    for(SysInt pos = 0; pos < arity; ++pos)
+      findSqueezeGroups(tuples, pos, domSizes[pos], groups[pos]);
+    return groups;
+  }
+
+  // Each position is independent, so hand them out to threads.
+  std::atomic<SysInt> nextPos(0);
+  auto worker = [&]() {
+    SysInt pos;
+    while((pos = nextPos++) < arity)
+      findSqueezeGroups(tuples, pos, domSizes[pos], groups[pos]);
+  };
+
+  std::vector<std::thread> pool;
+  for(SysInt i = 0; i < threads - 1; ++i)
+    pool.push_back(std::thread(worker));
+  worker();
+  for(size_t i = 0; i < pool.size(); ++i)
+    pool[i].join();
+  return groups;
+}
+
+// Performs one round of squeezing. Returns the tuples which were not
+// squeezed, and the new tuples (each of which has one more freeValue).
+// In eager mode each tuple may be squeezed into at most one new tuple, and
+// tuples are considered in lexicographic order, one position at a time.
+inline std::pair<FlatTuples, FlatTuples> squeeze_tuples(const FlatTuples& tuples,
+                                                        const std::vector<SysInt>& domSizes,
+                                                        bool eager_prune) {
+  const SysInt arity = tuples.tupleSize();
+  std::vector<SqueezeGroups> groups = findAllSqueezeGroups(tuples, domSizes);
+
+  std::vector<char> used(tuples.size(), 0);
+  FlatTuples ret_tuples(arity);
+  Vint tupleCopy(arity);
+
+  if(eager_prune) {
+    for(SysInt t = 0; t < tuples.size(); ++t) {
+      for(SysInt pos = 0; pos < arity && !used[t]; ++pos) {
+        SysInt g = groups[pos].groupOf[t];
+        if(g == -1 || groups[pos].usedCount[g] != 0)
           continue;
 
-        Vint tupleCopy = tuple;
-        bool found = true;
-        for(std::set<DomainInt>::iterator it = domains[i].begin(); it != domains[i].end(); ++it) {
-          DomainInt j = *it;
-          tupleCopy[i] = j;
-          if(tuples.count(tupleCopy) == 0 || (eager_prune && used_tuples.count(tupleCopy) != 0)) {
-            found = false;
-            break;
+        const SysInt* group = groups[pos].group(g);
+        for(SysInt m = 0; m < groups[pos].groupSize; ++m) {
+          used[group[m]] = 1;
+          for(SysInt p = 0; p < arity; ++p) {
+            SysInt other = groups[p].groupOf[group[m]];
+            if(other != -1)
+              groups[p].usedCount[other]++;
           }
         }
-        if(found) {
-          for(std::set<DomainInt>::iterator it = domains[i].begin(); it != domains[i].end(); ++it) {
-            DomainInt j = *it;
-            tupleCopy[i] = j;
-            used_tuples.insert(tupleCopy);
-          }
-          tupleCopy[i] = freeValue;
-          // std::cout << tupleCopy << std::endl;
-          ret_tuples.insert(tupleCopy);
-        }
+
+        std::copy(tuples[t], tuples[t] + arity, tupleCopy.begin());
+        tupleCopy[pos] = freeValue;
+        ret_tuples.push_back(tupleCopy.data());
+      }
+    }
+  } else {
+    for(SysInt pos = 0; pos < arity; ++pos) {
+      for(SysInt g = 0; g < groups[pos].groupCount(); ++g) {
+        const SysInt* group = groups[pos].group(g);
+        for(SysInt m = 0; m < groups[pos].groupSize; ++m)
+          used[group[m]] = 1;
+
+        std::copy(tuples[group[0]], tuples[group[0]] + arity, tupleCopy.begin());
+        tupleCopy[pos] = freeValue;
+        ret_tuples.push_back(tupleCopy.data());
       }
     }
   }
 
-  std::set<Vint> filtered_tuples;
-  for(std::set<Vint>::iterator it = tuples.begin(); it != tuples.end(); ++it) {
-    if(used_tuples.count(*it) == 0)
-      filtered_tuples.insert(*it);
+  ret_tuples.sortAndUnique();
+
+  FlatTuples filtered_tuples(arity);
+  for(SysInt t = 0; t < tuples.size(); ++t) {
+    if(!used[t])
+      filtered_tuples.push_back(tuples[t]);
   }
-  return std::make_pair(filtered_tuples, ret_tuples);
+  return std::make_pair(std::move(filtered_tuples), std::move(ret_tuples));
 }
 
-template <typename Tuples>
-std::vector<std::set<DomainInt>> gatherDomains(const Tuples& tuples) {
+inline std::vector<std::set<DomainInt>> gatherDomains(const FlatTuples& tuples) {
   if(tuples.size() == 0)
     return std::vector<std::set<DomainInt>>();
 
-  std::vector<std::set<DomainInt>> domains((tuples.begin())->size());
+  std::vector<std::set<DomainInt>> domains(tuples.tupleSize());
 
-  for(std::set<Vint>::iterator it = tuples.begin(); it != tuples.end(); ++it) {
-    for(SysInt i = 0; i < (SysInt)it->size(); ++i) {
-      domains[i].insert((*it)[i]);
-    }
+  Vint column(tuples.size());
+  for(SysInt i = 0; i < tuples.tupleSize(); ++i) {
+    for(SysInt j = 0; j < tuples.size(); ++j)
+      column[j] = tuples[j][i];
+    std::sort(column.begin(), column.end());
+    domains[i] = std::set<DomainInt>(column.begin(), std::unique(column.begin(), column.end()));
   }
 
   return domains;
 }
 
-inline std::set<Vint> full_squeeze_tuples(std::set<Vint> tuples,
-                                          const std::vector<std::set<DomainInt>>& domainMax,
-                                          bool eager) {
-  std::set<Vint> constraint;
+// 'tuples' must be sorted and contain no duplicates.
+inline FlatTuples full_squeeze_tuples(FlatTuples tuples,
+                                      const std::vector<std::set<DomainInt>>& domainMax,
+                                      bool eager) {
+  std::vector<SysInt> domSizes;
+  for(SysInt i = 0; i < (SysInt)domainMax.size(); ++i)
+    domSizes.push_back(domainMax[i].size());
+  domSizes.resize(tuples.tupleSize(), 0);
+
+  FlatTuples constraint(tuples.tupleSize());
   while(true) {
-    std::pair<std::set<Vint>, std::set<Vint>> pair_ret = squeeze_tuples(tuples, domainMax, eager);
-    for(std::set<Vint>::iterator it = pair_ret.first.begin(); it != pair_ret.first.end(); ++it)
-      constraint.insert(*it);
-    if(pair_ret.second.empty())
-      return constraint; //    exit(0);
-    tuples = pair_ret.second;
+    std::pair<FlatTuples, FlatTuples> pair_ret = squeeze_tuples(tuples, domSizes, eager);
+    constraint.append(pair_ret.first);
+    if(pair_ret.second.empty()) {
+      constraint.sortAndUnique();
+      return constraint;
+    }
+    tuples = std::move(pair_ret.second);
   }
 }
 
 inline std::vector<std::vector<std::pair<SysInt, DomainInt>>>
-makeShortTupleList(const std::set<Vint>& tuples) {
+makeShortTupleList(const FlatTuples& tuples) {
   std::vector<std::vector<std::pair<SysInt, DomainInt>>> out;
-  for(std::set<Vint>::const_iterator it = tuples.begin(); it != tuples.end(); ++it) {
+  out.reserve(tuples.size());
+  for(SysInt t = 0; t < tuples.size(); ++t) {
     std::vector<std::pair<SysInt, DomainInt>> shortTup;
-    for(SysInt i = 0; i < (SysInt)it->size(); ++i) {
-      if((*it)[i] != freeValue) {
-        shortTup.push_back(std::make_pair(i, (*it)[i]));
+    for(SysInt i = 0; i < tuples.tupleSize(); ++i) {
+      if(tuples[t][i] != freeValue) {
+        shortTup.push_back(std::make_pair(i, tuples[t][i]));
       }
     }
     out.push_back(shortTup);
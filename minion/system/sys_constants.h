@@ -113,4 +113,6 @@ inline T mymax(T t1, T t2) {
 
 enum MapLongTuplesToShort { MLTTS_NoMap, MLTTS_KeepLong, MLTTS_Eager, MLTTS_Lazy };
 
+enum SymmetryBreak { SB_None, SB_Lex, SB_Dynamic };
+
 #endif // _SYS_CONSTANTS_H
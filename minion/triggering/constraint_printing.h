@@ -48,6 +48,10 @@ inline string print_vars(ShortTupleList* const& t) {
   return t->getName();
 }
 
+inline string print_vars(SmartTupleList* const& t) {
+  return t->getName();
+}
+
 inline string print_vars(AbstractConstraint* const& c);
 
 inline string print_vars(const DomainInt& i) {
@@ -29,10 +29,19 @@
 #include "memory_management/MemoryBlock.h"
 #include "memory_management/nonbacktrack_memory.h"
 
+/// The triggers on one variable. The lists for the four trigger types always
+/// exist. The lists for DomainRemoval of each value are made in pages of
+/// ValuesPerPage values (fewer for the last page), the first time a trigger is
+/// added to a value in the page, so a large domain costs one pointer per page
+/// until it is used.
+/// Lists never move once made, as triggers refer to them by pointer.
 struct TriggerObj {
+  static const SysInt ValuesPerPage = 64;
+
   DomainInt min;
   DomainInt max;
   vector<DynamicTriggerList> _dynamicTriggers;
+  vector<std::unique_ptr<DynamicTriggerList[]>> _valuePages;
 
   TriggerObj() : min(-1), max(-1) {}
 
@@ -41,15 +50,31 @@ struct TriggerObj {
     return &_dynamicTriggers[checked_cast<SysInt>(type)];
   }
 
+  /// The list for val, or NULL if no trigger was ever added to it.
+  DynamicTriggerList* domainValIfMade(DomainInt val) {
+    D_ASSERT(val >= min && val <= max);
+    SysInt offset = checked_cast<SysInt>(val - min);
+    DynamicTriggerList* page = _valuePages[offset / ValuesPerPage].get();
+    return page ? page + offset % ValuesPerPage : NULL;
+  }
+
+  /// The list for val, made if needed.
   DynamicTriggerList* domainVal(DomainInt val) {
     D_ASSERT(val >= min && val <= max);
-    return &_dynamicTriggers[checked_cast<SysInt>(val - min + 4)];
+    SysInt offset = checked_cast<SysInt>(val - min);
+    std::unique_ptr<DynamicTriggerList[]>& page = _valuePages[offset / ValuesPerPage];
+    if(!page) {
+      SysInt pageSize = checked_cast<SysInt>(max - min + 1) - (offset - offset % ValuesPerPage);
+      if(pageSize > ValuesPerPage)
+        pageSize = ValuesPerPage;
+      page.reset(new DynamicTriggerList[pageSize]);
+    }
+    return page.get() + offset % ValuesPerPage;
   }
 
   // It is important this object is never copied, but it can be moved
   TriggerObj(TriggerObj&&) = default;
   TriggerObj(const TriggerObj*) = delete;
-
 };
 
 class TriggerList {
@@ -72,11 +97,10 @@ public:
     for(int i = 0; i < doms.size(); ++i) {
       dynTriggers[old_varCount + i].min = doms[i].first;
       dynTriggers[old_varCount + i].max = doms[i].second;
-      if(onlyBounds)
-        dynTriggers[old_varCount + i]._dynamicTriggers.resize(4);
-      else
-        dynTriggers[old_varCount + i]._dynamicTriggers.resize(
-            checked_cast<SysInt>(4 + (doms[i].second - doms[i].first + 1)));
+      dynTriggers[old_varCount + i]._dynamicTriggers.resize(4);
+      if(!onlyBounds)
+        dynTriggers[old_varCount + i]._valuePages.resize(checked_cast<SysInt>(
+            (doms[i].second - doms[i].first) / TriggerObj::ValuesPerPage + 1));
     }
   }
 
@@ -93,11 +117,11 @@ public:
       D_ASSERT(!onlyBounds);
       D_ASSERT(dynTriggers[varNum].min <= val_removed);
       D_ASSERT(dynTriggers[varNum].max >= val_removed);
-      trig = dynTriggers[varNum].domainVal(val_removed);
+      trig = dynTriggers[varNum].domainValIfMade(val_removed);
     }
 
     // This is an optimisation, no need to push empty lists.
-    if(!trig->empty())
+    if(trig && !trig->empty())
       getQueue().pushDynamicTriggers(DynamicTriggerEvent(trig, checked_cast<SysInt>(domain_delta)));
   }
 
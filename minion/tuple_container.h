@@ -43,8 +43,9 @@ class TupleTrieArray;
 class Regin;
 class EggShellData;
 struct HaggisGACTuples;
+struct MDD;
 
-inline size_t get_hashVal(DomainInt* ptr, SysInt length) {
+inline size_t get_hashVal(const DomainInt* ptr, SysInt length) {
   size_t hash_code = 1234;
   for(SysInt i = 0; i < length; ++i) {
     size_t val = checked_cast<SysInt>(ptr[i]);
@@ -54,21 +55,6 @@ inline size_t get_hashVal(DomainInt* ptr, SysInt length) {
   return hash_code;
 }
 
-inline SysInt get_hashVal(const vector<vector<DomainInt>>& vecs) {
-  SysInt hash_code = 1234;
-  for(SysInt i = 0; i < (SysInt)vecs.size(); ++i)
-    for(SysInt j = 0; j < (SysInt)vecs[i].size(); ++j) {
-      SysInt val = checked_cast<SysInt>(vecs[i][j]);
-      hash_code = (hash_code << 5) - hash_code + val;
-    }
-
-  SysInt totalSize = 0;
-  for(SysInt i = 0; i < (SysInt)vecs.size(); ++i)
-    totalSize += vecs[i].size();
-  hash_code += totalSize;
-  return hash_code;
-}
-
 class TupleList {
   string tuple_name;
 
@@ -77,13 +63,15 @@ class TupleList {
   TupleTrieArray* triearray;
   Regin* regin;
   EggShellData* egg;
+  MDD* mdd;
 
   DomainInt* tupleData;
   SysInt tupleLength;
   SysInt numberOfTuples;
   bool tuplesLocked;
+  bool mddOnly;
 
-  SysInt hash_code;
+  size_t hash_code;
 
 public:
   size_t get_hash() {
@@ -98,6 +86,12 @@ public:
   TupleTrieArray* getTries();
   Regin* getRegin();
   EggShellData* getEggShellData(size_t varcount);
+  MDD* getMDD();
+
+  /// True if this list was given only as an MDD, and so has no tuples.
+  bool isMDDOnly() const {
+    return mddOnly;
+  }
 
   /// Get raw pointer to the tuples.
   DomainInt* getPointer() {
@@ -122,35 +116,37 @@ public:
     return vec;
   }
 
-  TupleList(const vector<vector<DomainInt>>& tuple_list)
+  TupleList(DomainInt _numtuples, DomainInt _tuplelength)
       : litlists(NULL),
         nightingale(NULL),
         triearray(NULL),
         regin(NULL),
         egg(NULL),
+        mdd(NULL),
+        tupleLength(checked_cast<SysInt>(_tuplelength)),
+        numberOfTuples(checked_cast<SysInt>(_numtuples)),
         tuplesLocked(false),
+        mddOnly(false),
         hash_code(0) {
-    numberOfTuples = tuple_list.size();
-    tupleLength = tuple_list[0].size();
     tupleData = new DomainInt[numberOfTuples * tupleLength];
-    for(SysInt i = 0; i < numberOfTuples; ++i)
-      for(SysInt j = 0; j < tupleLength; ++j) {
-        tupleData[i * tupleLength + j] = tuple_list[i][j];
-      }
-    finalise_tuples();
   }
 
-  TupleList(DomainInt _numtuples, DomainInt _tuplelength)
+  /// A table given directly as an MDD. This has no explicit tuples, so can
+  /// only be used by constraints which use getMDD().
+  TupleList(MDD* _mdd, SysInt _tuplelength)
       : litlists(NULL),
         nightingale(NULL),
         triearray(NULL),
         regin(NULL),
         egg(NULL),
-        tupleLength(checked_cast<SysInt>(_tuplelength)),
-        numberOfTuples(checked_cast<SysInt>(_numtuples)),
+        mdd(_mdd),
+        tupleData(NULL),
+        tupleLength(_tuplelength),
+        numberOfTuples(0),
         tuplesLocked(false),
+        mddOnly(true),
         hash_code(0) {
-    tupleData = new DomainInt[numberOfTuples * tupleLength];
+    finalise_tuples();
   }
 
   const DomainInt* operator[](SysInt pos) const {
@@ -203,23 +199,24 @@ public:
       return;
     tuplesLocked = true;
 
-    DomainInt arity = tupleSize();
-
-    // Set up the table of tuples.
-    for(SysInt i = 0; i < arity; ++i) {
-      if(size() == 0) {
-        domSmallest.push_back(0);
-        domSize.push_back(0);
-      } else {
-        DomainInt minVal = getTupleptr(0)[i];
-        DomainInt maxVal = getTupleptr(0)[i];
-        for(SysInt j = 1; j < size(); ++j) {
-          minVal = mymin(minVal, getTupleptr(j)[i]);
-          maxVal = mymax(maxVal, getTupleptr(j)[i]);
+    // Set up the table of tuples. This makes a single pass over the tuples
+    // in the order they are stored, as tables can be very large.
+    if(size() == 0) {
+      domSmallest.assign(tupleLength, 0);
+      domSize.assign(tupleLength, 0);
+    } else {
+      vector<DomainInt> minVal(tupleData, tupleData + tupleLength);
+      vector<DomainInt> maxVal(tupleData, tupleData + tupleLength);
+      for(SysInt j = 1; j < numberOfTuples; ++j) {
+        const DomainInt* tuple = tupleData + (size_t)j * tupleLength;
+        for(SysInt i = 0; i < tupleLength; ++i) {
+          minVal[i] = mymin(minVal[i], tuple[i]);
+          maxVal[i] = mymax(maxVal[i], tuple[i]);
         }
-        domSmallest.push_back(minVal);
-        domSize.push_back(maxVal - minVal + 1);
       }
+      domSmallest = minVal;
+      for(SysInt i = 0; i < tupleLength; ++i)
+        domSize.push_back(maxVal[i] - minVal[i] + 1);
     }
 
     SysInt domSizeSize = checked_cast<SysInt>(domSize.size());
@@ -253,32 +250,29 @@ public:
     return tuplelistPtr;
   }
 
-  TupleList* getNewTupleList(const vector<vector<DomainInt>>& tuples) {
-    size_t tuple_hash = get_hashVal(tuples);
+  /// Returns a list of the tuples stored one after another in 'tuples',
+  /// reusing an existing list if one is equal.
+  TupleList* getNewTupleList(const vector<DomainInt>& tuples, SysInt tuplelength) {
+    const SysInt numtuples = tuplelength == 0 ? 0 : tuples.size() / tuplelength;
+    size_t tuple_hash = get_hashVal(tuples.data(), tuples.size());
     for(SysInt i = 0; i < (SysInt)InternalTupleList.size(); ++i) {
-      bool equal = true;
-
-      if(InternalTupleList[i]->get_hash() != tuple_hash)
-        equal = false;
-      else {
-        TupleList* ptr = InternalTupleList[i];
-        if((SysInt)tuples.size() != ptr->size() || (SysInt)tuples[0].size() != ptr->tupleSize()) {
-          equal = false;
-        } else {
-          for(SysInt j = 0; j < (SysInt)tuples.size() && equal; ++j) {
-            for(SysInt k = 0; k < (SysInt)tuples[j].size() && equal; ++k)
-              if(tuples[j][k] != ptr->getTupleptr(j)[k]) {
-                equal = false;
-              }
-          }
-        }
-
-        if(equal)
-          return InternalTupleList[i];
-      }
+      TupleList* ptr = InternalTupleList[i];
+      if(ptr->isMDDOnly() || ptr->get_hash() != tuple_hash || ptr->size() != numtuples ||
+         ptr->tupleSize() != tuplelength)
+        continue;
+      if(std::equal(tuples.begin(), tuples.end(), ptr->getPointer()))
+        return ptr;
     }
 
-    TupleList* tuplelistPtr = new TupleList(tuples);
+    TupleList* tuplelistPtr = new TupleList(numtuples, tuplelength);
+    std::copy(tuples.begin(), tuples.end(), tuplelistPtr->getPointer());
+    tuplelistPtr->finalise_tuples();
+    InternalTupleList.push_back(tuplelistPtr);
+    return tuplelistPtr;
+  }
+
+  TupleList* getNewTupleList(MDD* mdd, SysInt tuplelength) {
+    TupleList* tuplelistPtr = new TupleList(mdd, tuplelength);
     InternalTupleList.push_back(tuplelistPtr);
     return tuplelistPtr;
   }
@@ -315,10 +309,11 @@ public:
   ShortTupleList(TupleList* longTuples, MapLongTuplesToShort method) {
     D_ASSERT(method != MLTTS_NoMap);
 
-    set<vector<DomainInt>> tupleSet;
-
+    FlatTuples tupleSet(checked_cast<SysInt>(longTuples->tupleSize()));
+    tupleSet.reserve(checked_cast<SysInt>(longTuples->size()));
     for(SysInt i = 0; i < longTuples->size(); ++i)
-      tupleSet.insert(longTuples->getVector(i));
+      tupleSet.push_back(longTuples->getTupleptr(i));
+    tupleSet.sortAndUnique();
 
     if(method == MLTTS_KeepLong) {
       shortTuples = makeShortTupleList(tupleSet);
@@ -328,8 +323,8 @@ public:
     D_ASSERT(method == MLTTS_Lazy || method == MLTTS_Eager);
 
     initialDomainList = gatherDomains(tupleSet);
-    set<vector<DomainInt>> squashed =
-        full_squeeze_tuples(tupleSet, initialDomainList, (method == MLTTS_Eager));
+    FlatTuples squashed =
+        full_squeeze_tuples(std::move(tupleSet), initialDomainList, (method == MLTTS_Eager));
     shortTuples = makeShortTupleList(squashed);
 
     cout << "# Squashed " + longTuples->getName() + " : " << longTuples->size() << " -> "
@@ -457,4 +452,7 @@ inline LiteralSpecificLists* TupleList::getLitLists() {
   return litlists;
 }
 
+#include "mdd_container.h"
+#include "smart_tuple_container.h"
+
 #endif
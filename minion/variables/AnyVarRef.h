@@ -48,6 +48,8 @@
 
 #include "../triggering/dynamic_trigger.h"
 
+#include "domain_bulk.h"
+
 class AbstractConstraint;
 
 /// Internal type used by AnyVarRef.
@@ -69,6 +71,10 @@ struct AnyVarRef_Abstract {
   virtual void uncheckedAssign(DomainInt b) = 0;
   virtual void assign(DomainInt b) = 0;
   virtual void removeFromDomain(DomainInt b) = 0;
+  virtual void removeValues(const vector<DomainInt>& vals) = 0;
+  virtual void intersectWith(const DomainBitset& keep) = 0;
+  virtual void forEachValue(const std::function<void(DomainInt)>& f) const = 0;
+  virtual DomainBitset domainAsBitset() const = 0;
   virtual vector<AbstractConstraint*>* getConstraints() = 0;
   virtual void addConstraint(AbstractConstraint* c) = 0;
   virtual DomainInt getBaseVal(DomainInt) const = 0;
@@ -165,6 +171,22 @@ struct AnyVarRef_Concrete : public AnyVarRef_Abstract {
     data.removeFromDomain(b);
   }
 
+  virtual void removeValues(const vector<DomainInt>& vals) {
+    data.removeValues(vals);
+  }
+
+  virtual void intersectWith(const DomainBitset& keep) {
+    data.intersectWith(keep);
+  }
+
+  virtual void forEachValue(const std::function<void(DomainInt)>& f) const {
+    data.forEachValue(f);
+  }
+
+  virtual DomainBitset domainAsBitset() const {
+    return data.domainAsBitset();
+  }
+
   virtual vector<AbstractConstraint*>* getConstraints() {
     return data.getConstraints();
   }
@@ -304,6 +326,22 @@ public:
     data->removeFromDomain(b);
   }
 
+  void removeValues(const vector<DomainInt>& vals) {
+    data->removeValues(vals);
+  }
+
+  void intersectWith(const DomainBitset& keep) {
+    data->intersectWith(keep);
+  }
+
+  void forEachValue(const std::function<void(DomainInt)>& f) const {
+    data->forEachValue(f);
+  }
+
+  DomainBitset domainAsBitset() const {
+    return data->domainAsBitset();
+  }
+
   vector<AbstractConstraint*>* getConstraints() {
     return data->getConstraints();
   }
@@ -0,0 +1,224 @@
+/*
+ * Minion http://minion.sourceforge.net
+ * Copyright (C) 2006-09
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+#ifndef TAGGEDVARREF_H
+#define TAGGEDVARREF_H
+
+// Runs the rest of the arguments with v bound to the variable var refers to,
+// as its real type.
+#define TAGGED_VAR_SWITCH(v, ...)                                                                  \
+  switch(var.type()) {                                                                             \
+  case VAR_BOOL: {                                                                                 \
+    BoolVarRef v = getVars().boolVarContainer.getVarNum(var.pos());                                \
+    __VA_ARGS__;                                                                                   \
+  }                                                                                                \
+  case VAR_NOTBOOL: {                                                                              \
+    VarNot<BoolVarRef> v = VarNotRef(getVars().boolVarContainer.getVarNum(var.pos()));            \
+    __VA_ARGS__;                                                                                   \
+  }                                                                                                \
+  case VAR_BOUND: {                                                                                \
+    BoundVarRef v = getVars().boundVarContainer.getVarNum(var.pos());                              \
+    __VA_ARGS__;                                                                                   \
+  }                                                                                                \
+  case VAR_SPARSEBOUND: {                                                                          \
+    SparseBoundVarRef v = getVars().sparseBoundVarContainer.getVarNum(var.pos());                  \
+    __VA_ARGS__;                                                                                   \
+  }                                                                                                \
+  case VAR_DISCRETE: {                                                                             \
+    BigRangeVarRef v = getVars().bigRangeVarContainer.getVarNum(var.pos());                        \
+    __VA_ARGS__;                                                                                   \
+  }                                                                                                \
+  case VAR_CONSTANT: {                                                                             \
+    ConstantVar v(var.pos());                                                                      \
+    __VA_ARGS__;                                                                                   \
+  }                                                                                                \
+  default: FATAL_REPORTABLE_ERROR();                                                               \
+  }
+
+/// A reference to a variable as it appears in the input: a BOOL or its
+/// negation, a BOUND, SPARSEBOUND or DISCRETE variable, or a constant.
+/// AnyVarRef holds a pointer to an object and calls it through a virtual
+/// table; this only holds the Var, and switches on its type on each call,
+/// so it needs no allocation and every call can be inlined. BuildCon uses it
+/// to build constraints whose variables are not all of the same type.
+struct TaggedVarRef {
+  static const BOOL isBool = false;
+  static const BoundType isBoundConst = Bound_Maybe;
+
+  Var var;
+
+  TaggedVarRef() {}
+
+  explicit TaggedVarRef(Var _var) : var(_var) {}
+
+  BOOL isBound() const {
+    TAGGED_VAR_SWITCH(v, return v.isBound());
+  }
+
+  AnyVarRef popOneMapper() const {
+    TAGGED_VAR_SWITCH(v, return v.popOneMapper());
+  }
+
+  BOOL isAssigned() const {
+    TAGGED_VAR_SWITCH(v, return v.isAssigned());
+  }
+
+  DomainInt assignedValue() const {
+    TAGGED_VAR_SWITCH(v, return v.assignedValue());
+  }
+
+  BOOL isAssignedValue(DomainInt i) const {
+    TAGGED_VAR_SWITCH(v, return v.isAssigned() && v.assignedValue() == i);
+  }
+
+  BOOL inDomain(DomainInt b) const {
+    TAGGED_VAR_SWITCH(v, return v.inDomain(b));
+  }
+
+  BOOL inDomain_noBoundCheck(DomainInt b) const {
+    TAGGED_VAR_SWITCH(v, return v.inDomain_noBoundCheck(b));
+  }
+
+  DomainInt domSize() const {
+    TAGGED_VAR_SWITCH(v, return v.domSize());
+  }
+
+  DomainInt max() const {
+    TAGGED_VAR_SWITCH(v, return v.max());
+  }
+
+  DomainInt min() const {
+    TAGGED_VAR_SWITCH(v, return v.min());
+  }
+
+  DomainInt initialMax() const {
+    TAGGED_VAR_SWITCH(v, return v.initialMax());
+  }
+
+  DomainInt initialMin() const {
+    TAGGED_VAR_SWITCH(v, return v.initialMin());
+  }
+
+  void setMax(DomainInt i) {
+    TAGGED_VAR_SWITCH(v, return v.setMax(i));
+  }
+
+  void setMin(DomainInt i) {
+    TAGGED_VAR_SWITCH(v, return v.setMin(i));
+  }
+
+  void uncheckedAssign(DomainInt b) {
+    TAGGED_VAR_SWITCH(v, return v.uncheckedAssign(b));
+  }
+
+  void assign(DomainInt b) {
+    TAGGED_VAR_SWITCH(v, return v.assign(b));
+  }
+
+  void removeFromDomain(DomainInt b) {
+    TAGGED_VAR_SWITCH(v, return v.removeFromDomain(b));
+  }
+
+  void removeValues(const vector<DomainInt>& vals) {
+    TAGGED_VAR_SWITCH(v, return v.removeValues(vals));
+  }
+
+  void intersectWith(const DomainBitset& keep) {
+    TAGGED_VAR_SWITCH(v, return v.intersectWith(keep));
+  }
+
+  template <typename F>
+  void forEachValue(F f) const {
+    TAGGED_VAR_SWITCH(v, return v.forEachValue(f));
+  }
+
+  DomainBitset domainAsBitset() const {
+    TAGGED_VAR_SWITCH(v, return v.domainAsBitset());
+  }
+
+  vector<AbstractConstraint*>* getConstraints() {
+    TAGGED_VAR_SWITCH(v, return v.getConstraints());
+  }
+
+  void addConstraint(AbstractConstraint* c) {
+    TAGGED_VAR_SWITCH(v, return v.addConstraint(c));
+  }
+
+  DomainInt getBaseVal(DomainInt i) const {
+    TAGGED_VAR_SWITCH(v, return v.getBaseVal(i));
+  }
+
+  Var getBaseVar() const {
+    TAGGED_VAR_SWITCH(v, return v.getBaseVar());
+  }
+
+  vector<Mapper> getMapperStack() const {
+    TAGGED_VAR_SWITCH(v, return v.getMapperStack());
+  }
+
+#ifdef WDEG
+  DomainInt getBaseWdeg() {
+    TAGGED_VAR_SWITCH(v, return v.getBaseWdeg());
+  }
+
+  void incWdeg() {
+    TAGGED_VAR_SWITCH(v, return v.incWdeg());
+  }
+#endif
+
+  friend std::ostream& operator<<(std::ostream& o, const TaggedVarRef& tv) {
+    const Var& var = tv.var;
+    TAGGED_VAR_SWITCH(v, return o << v);
+  }
+
+  DomainInt getDomainChange(DomainDelta d) {
+    TAGGED_VAR_SWITCH(v, return v.getDomainChange(d));
+  }
+
+  void addDynamicTrigger(Trig_ConRef t, TrigType type, DomainInt pos = NoDomainValue,
+                         TrigOp op = TO_Default) {
+    TAGGED_VAR_SWITCH(v, return v.addDynamicTrigger(t, type, pos, op));
+  }
+
+  friend bool operator==(const TaggedVarRef& lhs, const TaggedVarRef& rhs) {
+    return lhs.getBaseVar() == rhs.getBaseVar();
+  }
+
+  friend bool operator!=(const TaggedVarRef& lhs, const TaggedVarRef& rhs) {
+    return lhs.getBaseVar() != rhs.getBaseVar();
+  }
+
+  friend bool operator<(const TaggedVarRef& lhs, const TaggedVarRef& rhs) {
+    return lhs.getBaseVar() < rhs.getBaseVar();
+  }
+};
+
+#undef TAGGED_VAR_SWITCH
+
+namespace std {
+template <>
+struct hash<TaggedVarRef> {
+  size_t operator()(const TaggedVarRef& tv) const {
+    return getHash(tv.getBaseVar());
+  }
+};
+} // namespace std
+
+#endif
@@ -111,6 +111,23 @@ struct VarRefType {
     GET_CONTAINER().removeFromDomain(data, b);
   }
 
+  void removeValues(const vector<DomainInt>& vals) {
+    GET_CONTAINER().removeValues(data, vals);
+  }
+
+  void intersectWith(const DomainBitset& keep) {
+    GET_CONTAINER().intersectWith(data, keep);
+  }
+
+  template <typename F>
+  void forEachValue(F f) const {
+    GET_CONTAINER().forEachValue(data, f);
+  }
+
+  DomainBitset domainAsBitset() const {
+    return GET_CONTAINER().domainAsBitset(data);
+  }
+
   vector<AbstractConstraint*>* getConstraints() {
     return GET_CONTAINER().getConstraints(data);
   }
@@ -238,6 +255,23 @@ struct QuickVarRefType {
     GET_CONTAINER().removeFromDomain(data, b);
   }
 
+  void removeValues(const vector<DomainInt>& vals) {
+    genericRemoveValues(*this, vals);
+  }
+
+  void intersectWith(const DomainBitset& keep) {
+    genericIntersectWith(*this, keep);
+  }
+
+  template <typename F>
+  void forEachValue(F f) const {
+    genericForEachValue(*this, f);
+  }
+
+  DomainBitset domainAsBitset() const {
+    return genericDomainAsBitset(*this);
+  }
+
   vector<AbstractConstraint*>* getConstraints() {
     return GET_CONTAINER().getConstraints(data);
   }
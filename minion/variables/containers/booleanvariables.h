@@ -36,14 +36,10 @@ also appear. A boolean variable x's negation is identified by !x.
 
 #include "../../triggering/constraint_abstract.h"
 
-/// Standard data type used for storing compressed booleans
-typedef unsigned long data_type;
-static const data_type one = 1;
-static const data_type maxData = one << (sizeof(data_type) - 1);
-
 struct BoolVarContainer;
 
-/// A reference to a boolean variable
+/// A reference to a boolean variable. This is only the number of the
+/// variable; its state is found through the container.
 struct BoolVarRef_internal {
   static const BOOL isBool = true;
   static const BoundType isBoundConst = Bound_No;
@@ -58,49 +54,17 @@ struct BoolVarRef_internal {
     FATAL_REPORTABLE_ERROR();
   }
 
-  data_type shiftOffset;
   SysInt varNum;
-  void* data_position;
-  void* value_position;
-
-  UnsignedSysInt dataOffset() const {
-    return varNum / (sizeof(data_type) * 8);
-  }
 
   static BoolVarContainer& getCon_Static();
-  BoolVarRef_internal(const BoolVarRef_internal& b)
-      : shiftOffset(b.shiftOffset),
-        varNum(b.varNum),
-        data_position(b.data_position),
-        value_position(b.value_position) {}
 
-  void operator=(const BoolVarRef_internal& b) {
-    shiftOffset = b.shiftOffset;
-    varNum = b.varNum;
-    data_position = b.data_position;
-    value_position = b.value_position;
-  }
+  BoolVarRef_internal() : varNum(-1) {}
 
-  BoolVarRef_internal() : shiftOffset(~1), varNum(~1) {}
+  explicit BoolVarRef_internal(DomainInt value) : varNum(checked_cast<SysInt>(value)) {}
 
-  BoolVarRef_internal(DomainInt value, BoolVarContainer* b_con);
-
-  data_type& assign_ptr() const {
-    return *static_cast<data_type*>(data_position);
-  }
-
-  data_type& valuePtr() const {
-    return *static_cast<data_type*>(value_position);
-  }
-
-  BOOL isAssigned() const {
-    return assign_ptr() & shiftOffset;
-  }
-
-  DomainInt assignedValue() const {
-    D_ASSERT(isAssigned());
-    return (bool)(valuePtr() & shiftOffset);
-  }
+  // These are defined after BoolVarContainer.
+  inline BOOL isAssigned() const;
+  inline DomainInt assignedValue() const;
 
   BOOL inDomain(DomainInt b) const {
     if((checked_cast<SysInt>(b) | 1) != 1)
@@ -167,14 +131,18 @@ typedef InfoRefType<QuickVarRefType<GetBoolVarContainer, BoolVarRef_internal>, V
 typedef QuickVarRefType<GetBoolVarContainer, BoolVarRef_internal> BoolVarRef;
 #endif
 
-/// Container for boolean variables
+/// Container for boolean variables.
+///
+/// The state of each variable is two bits, packed 32 variables to a 64-bit
+/// word of backtrackable memory: bit 2i of word w is set when variable
+/// 32w + i is assigned, and bit 2i + 1 holds its value.
 struct BoolVarContainer {
+  typedef uint64_t Word;
+  static const SysInt VarsPerWord = 32;
 
   BoolVarContainer() : varCount_m(0), triggerList(false) {}
 
-  static const SysInt width = 7;
-  ExtendableBlock assignOffset;
-  void* values_mem;
+  ExtendableBlock stateBlock;
   vector<vector<AbstractConstraint*>> constraints;
 #ifdef WDEG
   vector<DomainInt> wdegs;
@@ -182,20 +150,36 @@ struct BoolVarContainer {
   UnsignedSysInt varCount_m;
   TriggerList triggerList;
 
-  data_type* valuePtr() {
-    return static_cast<data_type*>(values_mem);
+  static SysInt wordOf(SysInt varNum) {
+    return varNum / VarsPerWord;
+  }
+
+  /// The bit which is set in a state word when varNum is assigned. The bit
+  /// above it holds the value.
+  static Word assignedBit(SysInt varNum) {
+    return Word(1) << (2 * (varNum % VarsPerWord));
+  }
+
+  Word* state() {
+    return (Word*)(stateBlock());
   }
 
-  const data_type* valuePtr() const {
-    return static_cast<const data_type*>(values_mem);
+  const Word* state() const {
+    return (const Word*)(stateBlock());
   }
 
-  data_type* assign_ptr() {
-    return (data_type*)(assignOffset());
+  /// The packed state of variables 32w to 32w + 31.
+  Word stateWord(SysInt w) const {
+    return state()[w];
   }
 
-  const data_type* assign_ptr() const {
-    return (const data_type*)(assignOffset());
+  BOOL isAssigned(const BoolVarRef_internal& d) const {
+    return (state()[wordOf(d.varNum)] & assignedBit(d.varNum)) != 0;
+  }
+
+  DomainInt getAssignedValue(const BoolVarRef_internal& d) const {
+    D_ASSERT(isAssigned(d));
+    return (state()[wordOf(d.varNum)] & (assignedBit(d.varNum) << 1)) != 0;
   }
 
   /// Returns a new Boolean Variable.
@@ -204,15 +188,11 @@ struct BoolVarContainer {
   void addVariables(SysInt new_bools) {
     varCount_m += new_bools;
 
-    SysInt required_mem = varCount_m / 8 + 1;
-    // Round up to nearest data_type block
-    required_mem += sizeof(data_type) - (required_mem % sizeof(data_type));
-    if(assignOffset.empty()) {
-      assignOffset = getMemory().backTrack().requestBytesExtendable(required_mem);
-      values_mem = checked_malloc(512 * 1024 * 1024);
-      CHECK(required_mem < 512 * 1024 * 1024, "Bool mem overflow");
+    SysInt required_mem = (varCount_m / VarsPerWord + 1) * sizeof(Word);
+    if(stateBlock.empty()) {
+      stateBlock = getMemory().backTrack().requestBytesExtendable(required_mem);
     } else {
-      getMemory().backTrack().resizeExtendableBlock(assignOffset, required_mem);
+      getMemory().backTrack().resizeExtendableBlock(stateBlock, required_mem);
     }
     constraints.resize(varCount_m);
 #ifdef WDEG
@@ -257,8 +237,8 @@ struct BoolVarContainer {
     if((checked_cast<SysInt>(b) | 1) != 1)
       return;
 
-    if(d.isAssigned()) {
-      if(b == d.assignedValue())
+    if(isAssigned(d)) {
+      if(b == getAssignedValue(d))
         getState().setFailed(true);
     } else
       uncheckedAssign(d, 1 - b);
@@ -266,12 +246,13 @@ struct BoolVarContainer {
 
   void internalAssign(const BoolVarRef_internal& d, DomainInt b) {
     D_ASSERT(d.varNum < (SysInt)varCount_m);
-    D_ASSERT(!d.isAssigned());
+    D_ASSERT(!isAssigned(d));
     if((checked_cast<SysInt>(b) | 1) != 1) {
       getState().setFailed(true);
       return;
     }
-    assign_ptr()[d.dataOffset()] |= d.shiftOffset;
+    Word bit = assignedBit(d.varNum);
+    state()[wordOf(d.varNum)] |= (b == 1) ? (bit | bit << 1) : bit;
 
     triggerList.push_assign(d.varNum, b);
     triggerList.pushDomainChanged(d.varNum);
@@ -279,10 +260,8 @@ struct BoolVarContainer {
 
     if(b == 1) {
       triggerList.pushLower(d.varNum, 1);
-      valuePtr()[d.dataOffset()] |= d.shiftOffset;
     } else {
       triggerList.pushUpper(d.varNum, 1);
-      valuePtr()[d.dataOffset()] &= ~d.shiftOffset;
     }
   }
 
@@ -291,10 +270,10 @@ struct BoolVarContainer {
   }
 
   void assign(const BoolVarRef_internal& d, DomainInt b) {
-    if(!d.isAssigned())
+    if(!isAssigned(d))
       internalAssign(d, b);
     else {
-      if(d.assignedValue() != b)
+      if(getAssignedValue(d) != b)
         getState().setFailed(true);
     }
   }
@@ -328,16 +307,111 @@ struct BoolVarContainer {
 #endif
 };
 
+/// A list of literals, each a BOOL variable and the value which makes it
+/// true, grouped by the state word which holds them. Clause-like
+/// constraints can then test up to 32 literals with a few word operations.
+struct PackedBoolLiterals {
+  typedef BoolVarContainer::Word Word;
+
+  struct Group {
+    SysInt word;
+    // The assigned bit of each variable in the group.
+    Word vars;
+    // The assigned bit of each variable whose literal is true when it is 1.
+    Word positive;
+    // Where the positions of this group's literals start in position.
+    SysInt first;
+  };
+
+  vector<Group> groups;
+  // The position in the original list of each literal, by group and then
+  // by bit.
+  vector<SysInt> position;
+
+  PackedBoolLiterals() {}
+
+  /// Each literal is a variable number and whether the literal is the
+  /// variable being 1. No variable may appear twice.
+  explicit PackedBoolLiterals(const vector<pair<SysInt, bool>>& literals) {
+    vector<pair<SysInt, SysInt>> order;
+    for(SysInt i = 0; i < (SysInt)literals.size(); ++i)
+      order.push_back(make_pair(literals[i].first, i));
+    std::sort(order.begin(), order.end());
+    for(const auto& o : order) {
+      SysInt w = BoolVarContainer::wordOf(o.first);
+      if(groups.empty() || groups.back().word != w)
+        groups.push_back(Group{w, 0, 0, (SysInt)position.size()});
+      Word bit = BoolVarContainer::assignedBit(o.first);
+      D_ASSERT(!(groups.back().vars & bit));
+      groups.back().vars |= bit;
+      if(literals[o.second].second)
+        groups.back().positive |= bit;
+      position.push_back(o.second);
+    }
+  }
+
+  /// The assigned bits of the literals in g which are not false.
+  static Word notFalse(const Group& g, Word state) {
+    Word assigned = state & g.vars;
+    Word value = (state >> 1) & g.vars;
+    return g.vars & ~(assigned & (value ^ g.positive));
+  }
+
+  /// The position of a literal which is not false, other than skip, or -1
+  /// if there is none. The search starts at group start and wraps around;
+  /// start is set to the group the literal was found in.
+  SysInt findNotFalse(SysInt skip, SysInt& start) const {
+    const BoolVarContainer& con = BoolVarRef_internal::getCon_Static();
+    SysInt groupCount = groups.size();
+    for(SysInt i = 0; i < groupCount; ++i) {
+      SysInt gi = (start + i < groupCount) ? start + i : start + i - groupCount;
+      const Group& g = groups[gi];
+      for(Word bits = notFalse(g, con.stateWord(g.word)); bits; bits &= bits - 1) {
+        Word low = bits & (~bits + 1);
+        SysInt pos = position[g.first + __builtin_popcountll(g.vars & (low - 1))];
+        if(pos != skip) {
+          start = gi;
+          return pos;
+        }
+      }
+    }
+    return -1;
+  }
+};
+
+/// Builds literals for "var is 1" for each var, if every var is a BOOL or
+/// the negation of one and no BOOL appears twice.
+template <typename VarArray>
+bool makePackedBoolLiterals(const VarArray& vars, PackedBoolLiterals& packed) {
+  vector<pair<SysInt, bool>> literals;
+  std::set<SysInt> seen;
+  for(const auto& v : vars) {
+    Var base = v.getBaseVar();
+    if(base.type() != VAR_BOOL || !seen.insert(base.pos()).second)
+      return false;
+    vector<Mapper> mappers = v.getMapperStack();
+    if(mappers.empty())
+      literals.push_back(make_pair(base.pos(), true));
+    else if(mappers.size() == 1 && mappers[0].type() == MAP_NOT)
+      literals.push_back(make_pair(base.pos(), false));
+    else
+      return false;
+  }
+  packed = PackedBoolLiterals(literals);
+  return true;
+}
+
 inline BoolVarRef BoolVarContainer::getVarNum(DomainInt i) {
   D_ASSERT(i < (SysInt)varCount_m);
-  return BoolVarRef(BoolVarRef_internal(i, this));
+  return BoolVarRef(BoolVarRef_internal(i));
+}
+
+inline BOOL BoolVarRef_internal::isAssigned() const {
+  return getCon_Static().isAssigned(*this);
 }
 
-inline BoolVarRef_internal::BoolVarRef_internal(DomainInt value, BoolVarContainer* b_con)
-    : varNum(checked_cast<UnsignedSysInt>(value)),
-      data_position((char*)(b_con->assignOffset()) + dataOffset() * sizeof(data_type)),
-      value_position((char*)(b_con->values_mem) + dataOffset() * sizeof(data_type)) {
-  shiftOffset = one << (checked_cast<UnsignedSysInt>(value) % (sizeof(data_type) * 8));
+inline DomainInt BoolVarRef_internal::assignedValue() const {
+  return getCon_Static().getAssignedValue(*this);
 }
 
 #endif
@@ -124,6 +124,23 @@ struct BoundVarRef_internal {
     GET_LOCAL_CON().removeFromDomain(*this, b);
   }
 
+  void removeValues(const vector<DomainInt>& vals) {
+    genericRemoveValues(*this, vals);
+  }
+
+  void intersectWith(const DomainBitset& keep) {
+    genericIntersectWith(*this, keep);
+  }
+
+  template <typename F>
+  void forEachValue(F f) const {
+    genericForEachValue(*this, f);
+  }
+
+  DomainBitset domainAsBitset() const {
+    return genericDomainAsBitset(*this);
+  }
+
   vector<AbstractConstraint*>* getConstraints() {
     return GET_LOCAL_CON().getConstraints(*this);
   }
@@ -112,22 +112,18 @@ struct BigRangeVarContainer {
   DomainInt findNewUpperBound(BigRangeVarRef_internal d) {
     DomainInt lower = lowerBound(d);
     DomainInt oldUpBound = upperBound(d);
-    DomainInt loopvar = oldUpBound;
-    // DomainInt lowBound = initialBounds[d.varNum].first;
-    if(loopvar < lower) {
+    if(oldUpBound < lower) {
       getState().setFailed(true);
       /// Here just remove the value which should lead to the least work.
-      return upperBound(d);
+      return oldUpBound;
     }
-    if(bms_array->isMember(varOffset[d.varNum] + loopvar) && (loopvar >= lower))
-      return upperBound(d);
-    --loopvar;
-    for(; loopvar >= lower; --loopvar) {
-      if(bms_array->isMember(varOffset[d.varNum] + loopvar))
-        return loopvar;
+    DomainInt offset = varOffset[d.varNum];
+    DomainInt found = bms_array->prevMember(offset + oldUpBound, offset + lower);
+    if(found < offset + lower) {
+      getState().setFailed(true);
+      return oldUpBound;
     }
-    getState().setFailed(true);
-    return oldUpBound;
+    return found - offset;
   }
 
   /// Find new "true" lower bound.
@@ -137,22 +133,18 @@ struct BigRangeVarContainer {
   DomainInt findNewLowerBound(BigRangeVarRef_internal d) {
     DomainInt upper = upperBound(d);
     DomainInt old_lowBound = lowerBound(d);
-    DomainInt loopvar = old_lowBound;
-    // DomainInt lowBound = initialBounds[d.varNum].first;
-    if(loopvar > upper) {
+    if(old_lowBound > upper) {
       getState().setFailed(true);
       /// Here just remove the value which should lead to the least work.
-      return lowerBound(d);
+      return old_lowBound;
     }
-    if(bms_array->isMember(varOffset[d.varNum] + loopvar) && (loopvar <= upper))
-      return lowerBound(d);
-    ++loopvar;
-    for(; loopvar <= upper; ++loopvar) {
-      if(bms_array->isMember(varOffset[d.varNum] + loopvar))
-        return loopvar;
+    DomainInt offset = varOffset[d.varNum];
+    DomainInt found = bms_array->nextMember(offset + old_lowBound, offset + upper);
+    if(found > offset + upper) {
+      getState().setFailed(true);
+      return old_lowBound;
     }
-    getState().setFailed(true);
-    return old_lowBound;
+    return found - offset;
   }
 
   void addVariables(const vector<Bounds>& newDomains) {
@@ -226,12 +218,8 @@ struct BigRangeVarContainer {
   }
 
   DomainInt getDomSize_Check(BigRangeVarRef_internal d) const {
-    DomainInt domSize = 0;
-    for(DomainInt i = this->getMin(d); i <= this->getMax(d); ++i) {
-      if(this->inDomain(d, i))
-        domSize++;
-    }
-    return domSize;
+    DomainInt offset = varOffset[d.varNum];
+    return bms_array->countMembers(offset + lowerBound(d), offset + upperBound(d));
   }
 
   DomainInt getDomSize(BigRangeVarRef_internal d) const {
@@ -340,16 +328,13 @@ struct BigRangeVarContainer {
 private:
   // This function just unifies part of assign and uncheckedAssign
   void commonAssign(BigRangeVarRef_internal d, DomainInt offset, DomainInt lower, DomainInt upper) {
-    // TODO : Optimise this function to only check values in domain.
-    DomainInt domainOffset = varOffset[d.varNum] /*- initialBounds[d.varNum].first*/;
-    for(DomainInt loop = lower; loop <= upper; ++loop) {
-      // def of inDomain: bms_array->isMember(varOffset[d.varNum] + i -
-      // initialBounds[d.varNum].first);
-      if(bms_array->isMember(loop + domainOffset) && loop != offset) {
-        triggerList.pushDomain_removal(d.varNum, loop);
+    DomainInt domainOffset = varOffset[d.varNum];
+    bms_array->forEachMember(domainOffset + lower, domainOffset + upper, [&](DomainInt i) {
+      if(i - domainOffset != offset) {
+        triggerList.pushDomain_removal(d.varNum, i - domainOffset);
         reduceDomSize(d);
       }
-    }
+    });
     triggerList.pushDomainChanged(d.varNum);
     triggerList.push_assign(d.varNum, offset);
 
@@ -386,16 +371,12 @@ public:
     }
 
     if(offset < upBound) {
-      // TODO : Optimise this function to only check values in domain.
-      DomainInt domainOffset = varOffset[d.varNum] /*- initialBounds[d.varNum].first*/;
-      for(DomainInt loop = offset + 1; loop <= upBound; ++loop) {
-        // Def of inDomain: bms_array->isMember(varOffset[d.varNum] + i -
-        // initialBounds[d.varNum].first);
-        if(bms_array->isMember(domainOffset + loop)) {
-          triggerList.pushDomain_removal(d.varNum, loop);
-          reduceDomSize(d);
-        }
-      }
+      DomainInt domainOffset = varOffset[d.varNum];
+      bms_array->forEachMember(domainOffset + offset + 1, domainOffset + upBound,
+                               [&](DomainInt i) {
+                                 triggerList.pushDomain_removal(d.varNum, i - domainOffset);
+                                 reduceDomSize(d);
+                               });
       upperBound(d) = offset;
       DomainInt newUpper = findNewUpperBound(d);
       upperBound(d) = newUpper;
@@ -436,16 +417,12 @@ public:
     }
 
     if(offset > lowBound) {
-      // TODO : Optimise this function to only check values in domain.
-      DomainInt domainOffset = varOffset[d.varNum] /*- initialBounds[d.varNum].first*/;
-      for(DomainInt loop = lowBound; loop < offset; ++loop) {
-        // def of inDomain: bms_array->isMember(varOffset[d.varNum] + i -
-        // initialBounds[d.varNum].first);
-        if(bms_array->isMember(loop + domainOffset)) {
-          triggerList.pushDomain_removal(d.varNum, loop);
-          reduceDomSize(d);
-        }
-      }
+      DomainInt domainOffset = varOffset[d.varNum];
+      bms_array->forEachMember(domainOffset + lowBound, domainOffset + offset - 1,
+                               [&](DomainInt i) {
+                                 triggerList.pushDomain_removal(d.varNum, i - domainOffset);
+                                 reduceDomSize(d);
+                               });
       D_ASSERT(getState().isFailed() ||
                (inDomain(d, lowerBound(d)) && inDomain(d, upperBound(d))));
 
@@ -470,6 +447,112 @@ public:
 #endif
   }
 
+  /// Removes every value in [lower, upper] from the domain. Triggers on the
+  /// domain and bounds are pushed once, however many values go.
+  void removeRange(BigRangeVarRef_internal d, DomainInt lower, DomainInt upper) {
+    D_ASSERT(getState().isFailed() || (inDomain(d, lowerBound(d)) && inDomain(d, upperBound(d))));
+    lower = mymax(lower, lowerBound(d));
+    upper = mymin(upper, upperBound(d));
+    if(lower > upper)
+      return;
+    if(lower == lowerBound(d)) {
+      setMin(d, upper + 1);
+      return;
+    }
+    if(upper == upperBound(d)) {
+      setMax(d, lower - 1);
+      return;
+    }
+
+    // Both bounds stay, so only the inside of the domain changes.
+    DomainInt domainOffset = varOffset[d.varNum];
+    DomainInt removed = bms_array->removeRange(
+        domainOffset + lower, domainOffset + upper,
+        [&](DomainInt i) { triggerList.pushDomain_removal(d.varNum, i - domainOffset); });
+    afterBulkRemoval(d, lowerBound(d), upperBound(d), removed);
+  }
+
+  /// Removes every value in vals from the domain. Triggers on the domain and
+  /// bounds are pushed once, however many values go.
+  void removeValues(BigRangeVarRef_internal d, const vector<DomainInt>& vals) {
+    D_ASSERT(getState().isFailed() || (inDomain(d, lowerBound(d)) && inDomain(d, upperBound(d))));
+    DomainInt lowBound = lowerBound(d);
+    DomainInt upBound = upperBound(d);
+    DomainInt domainOffset = varOffset[d.varNum];
+    DomainInt removed = 0;
+    for(DomainInt v : vals) {
+      if(v >= lowBound && v <= upBound && bms_array->ifMember_remove(domainOffset + v)) {
+        triggerList.pushDomain_removal(d.varNum, v);
+        removed++;
+      }
+    }
+    afterBulkRemoval(d, lowBound, upBound, removed);
+  }
+
+  /// Removes every value not in keep. Triggers on the domain and bounds are
+  /// pushed once, however many values go.
+  void intersectWith(BigRangeVarRef_internal d, const DomainBitset& keep) {
+    D_ASSERT(getState().isFailed() || (inDomain(d, lowerBound(d)) && inDomain(d, upperBound(d))));
+    setMin(d, keep.base);
+    setMax(d, keep.maxValue());
+    if(getState().isFailed())
+      return;
+
+    DomainInt lowBound = lowerBound(d);
+    DomainInt upBound = upperBound(d);
+    DomainInt domainOffset = varOffset[d.varNum];
+    DomainInt removed = bms_array->removeUnmasked(
+        domainOffset + lowBound, domainOffset + upBound, keep.words.data(), lowBound - keep.base,
+        [&](DomainInt i) { triggerList.pushDomain_removal(d.varNum, i - domainOffset); });
+    afterBulkRemoval(d, lowBound, upBound, removed);
+  }
+
+  /// Calls f on each value in the domain, in increasing order.
+  template <typename F>
+  void forEachValue(BigRangeVarRef_internal d, F f) const {
+    DomainInt domainOffset = varOffset[d.varNum];
+    bms_array->forEachMember(domainOffset + lowerBound(d), domainOffset + upperBound(d),
+                             [&](DomainInt i) { f(i - domainOffset); });
+  }
+
+  DomainBitset domainAsBitset(BigRangeVarRef_internal d) const {
+    DomainBitset b(lowerBound(d), upperBound(d));
+    DomainInt domainOffset = varOffset[d.varNum];
+    bms_array->copyMembers(domainOffset + lowerBound(d), domainOffset + upperBound(d),
+                           b.words.data());
+    return b;
+  }
+
+private:
+  // Finishes off removing a batch of values from inside [lowBound, upBound],
+  // the bounds before the batch, by updating the size and bounds and pushing
+  // the triggers for the whole batch.
+  void afterBulkRemoval(BigRangeVarRef_internal d, DomainInt lowBound, DomainInt upBound,
+                        DomainInt removed) {
+    if(removed == 0)
+      return;
+
+    domSize(d) -= removed;
+#ifndef NO_DOMAIN_TRIGGERS
+    triggerList.pushDomainChanged(d.varNum);
+#endif
+    DomainInt domainOffset = varOffset[d.varNum];
+    if(!bms_array->isMember(domainOffset + lowBound)) {
+      lowerBound(d) = findNewLowerBound(d);
+      if(getState().isFailed())
+        return;
+      triggerList.pushLower(d.varNum, lowerBound(d) - lowBound);
+    }
+    if(!bms_array->isMember(domainOffset + upBound)) {
+      upperBound(d) = findNewUpperBound(d);
+      triggerList.pushUpper(d.varNum, upBound - upperBound(d));
+    }
+    if(lowerBound(d) == upperBound(d))
+      triggerList.push_assign(d.varNum, getAssignedValue(d));
+    D_ASSERT(getState().isFailed() || (inDomain(d, lowerBound(d)) && inDomain(d, upperBound(d))));
+  }
+
+public:
   BigRangeVarRef getVarNum(DomainInt i);
 
   UnsignedSysInt varCount() {
@@ -348,6 +348,58 @@ struct SparseBoundVarContainer {
     }
   }
 
+  /// Calls f on each value in the domain, in increasing order.
+  template <typename F>
+  void forEachValue(SparseBoundVarRef_internal<BoundType> d, F f) {
+    vector<BoundType>& dom = getDomain(d);
+    DomainInt upBound = upperBound(d);
+    for(auto it = std::lower_bound(dom.begin(), dom.end(), lowerBound(d));
+        it != dom.end() && *it <= upBound; ++it)
+      f(DomainInt(*it));
+  }
+
+  DomainBitset domainAsBitset(SparseBoundVarRef_internal<BoundType> d) {
+    DomainBitset b(lowerBound(d), upperBound(d));
+    forEachValue(d, [&](DomainInt v) { b.insert(v); });
+    return b;
+  }
+
+  void removeValues(SparseBoundVarRef_internal<BoundType> d, const vector<DomainInt>& vals) {
+    vector<DomainInt> sorted(vals);
+    std::sort(sorted.begin(), sorted.end());
+    removeWhere(d,
+                [&](DomainInt v) { return std::binary_search(sorted.begin(), sorted.end(), v); });
+  }
+
+  void intersectWith(SparseBoundVarRef_internal<BoundType> d, const DomainBitset& keep) {
+    removeWhere(d, [&](DomainInt v) { return !keep.contains(v); });
+  }
+
+private:
+  // Moves each bound past the values for which gone is true. Only the
+  // bounds can move, so any such value left inside is an error, as it is
+  // for removeFromDomain.
+  template <typename Pred>
+  void removeWhere(SparseBoundVarRef_internal<BoundType> d, Pred gone) {
+    vector<BoundType>& dom = getDomain(d);
+    auto lo = std::lower_bound(dom.begin(), dom.end(), lowerBound(d));
+    auto hi = std::upper_bound(dom.begin(), dom.end(), upperBound(d));
+    while(lo != hi && gone(*lo))
+      ++lo;
+    while(hi != lo && gone(*(hi - 1)))
+      --hi;
+    if(lo == hi) {
+      getState().setFailed(true);
+      return;
+    }
+    setMin(d, *lo);
+    setMax(d, *(hi - 1));
+    for(auto it = lo; it != hi; ++it)
+      if(gone(*it))
+        removeFromDomain(d, *it);
+  }
+
+public:
   //  SparseBoundVarRef get_new_var();
   template <typename T>
   SparseBoundVarRef get_new_var(const vector<T>&);
@@ -0,0 +1,149 @@
+/*
+ * Minion http://minion.sourceforge.net
+ * Copyright (C) 2006-09
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+#ifndef DOMAIN_BULK_H
+#define DOMAIN_BULK_H
+
+#include "../system/system.h"
+
+#include "../solver.h"
+
+// Operations on many values of a domain at once. Variables implement
+// removeValues, intersectWith, forEachValue and domainAsBitset; those whose
+// container can do better than one value at a time (DISCRETE) do so, and
+// the rest use the generic versions below.
+
+/// A set of values, held as one bit per value from base upwards.
+struct DomainBitset {
+  DomainInt base;
+  vector<uint64_t> words;
+
+  DomainBitset() : base(0) {}
+
+  /// An empty set, which can hold the values from lower to upper.
+  DomainBitset(DomainInt lower, DomainInt upper) {
+    reset(lower, upper);
+  }
+
+  /// Empties the set, and makes it able to hold the values lower to upper.
+  void reset(DomainInt lower, DomainInt upper) {
+    base = lower;
+    if(upper < lower)
+      words.clear();
+    else
+      words.assign(checked_cast<SysInt>((upper - lower) / 64 + 1), 0);
+  }
+
+  /// The largest value the set can hold.
+  DomainInt maxValue() const {
+    return base + (DomainInt)words.size() * 64 - 1;
+  }
+
+  bool contains(DomainInt v) const {
+    if(v < base || v > maxValue())
+      return false;
+    SysInt i = checked_cast<SysInt>(v - base);
+    return (words[i / 64] >> (i % 64)) & 1;
+  }
+
+  void insert(DomainInt v) {
+    D_ASSERT(v >= base && v <= maxValue());
+    SysInt i = checked_cast<SysInt>(v - base);
+    words[i / 64] |= uint64_t(1) << (i % 64);
+  }
+
+  /// Calls f on each value in the set, in increasing order.
+  template <typename F>
+  void forEach(F f) const {
+    for(SysInt w = 0; w < (SysInt)words.size(); ++w)
+      for(uint64_t bits = words[w]; bits; bits &= bits - 1)
+        f(base + w * 64 + __builtin_ctzll(bits));
+  }
+};
+
+/// Calls f on each value in the domain of var, in increasing order. f must
+/// not change the domain.
+template <typename Var, typename F>
+void genericForEachValue(const Var& var, F f) {
+  DomainInt upper = var.max();
+  for(DomainInt v = var.min(); v <= upper; ++v)
+    if(var.inDomain(v))
+      f(v);
+}
+
+template <typename Var>
+DomainBitset genericDomainAsBitset(const Var& var) {
+  DomainBitset b(var.min(), var.max());
+  genericForEachValue(var, [&](DomainInt v) { b.insert(v); });
+  return b;
+}
+
+// The generic removals move the bounds first, so variables which can only
+// change their bounds only see removeFromDomain for values strictly inside.
+
+template <typename Var>
+void genericRemoveValues(Var& var, const vector<DomainInt>& vals) {
+  vector<DomainInt> sorted(vals);
+  std::sort(sorted.begin(), sorted.end());
+  DomainInt lower = var.min();
+  DomainInt upper = var.max();
+  while(lower <= upper && std::binary_search(sorted.begin(), sorted.end(), lower)) {
+    do {
+      lower++;
+    } while(lower <= upper && !var.inDomain(lower));
+  }
+  while(upper >= lower && std::binary_search(sorted.begin(), sorted.end(), upper)) {
+    do {
+      upper--;
+    } while(upper >= lower && !var.inDomain(upper));
+  }
+  var.setMin(lower);
+  if(getState().isFailed())
+    return;
+  var.setMax(upper);
+  for(DomainInt v : sorted) {
+    if(getState().isFailed())
+      return;
+    if(v > lower && v < upper && var.inDomain(v))
+      var.removeFromDomain(v);
+  }
+}
+
+template <typename Var>
+void genericIntersectWith(Var& var, const DomainBitset& keep) {
+  DomainInt lower = var.min();
+  DomainInt upper = var.max();
+  while(lower <= upper && !(keep.contains(lower) && var.inDomain(lower)))
+    lower++;
+  while(upper >= lower && !(keep.contains(upper) && var.inDomain(upper)))
+    upper--;
+  var.setMin(lower);
+  if(getState().isFailed())
+    return;
+  var.setMax(upper);
+  for(DomainInt v = lower + 1; v < upper; ++v) {
+    if(getState().isFailed())
+      return;
+    if(!keep.contains(v) && var.inDomain(v))
+      var.removeFromDomain(v);
+  }
+}
+
+#endif
@@ -115,6 +115,23 @@ struct ConstantVar {
       getState().setFailed(true);
   }
 
+  void removeValues(const vector<DomainInt>& vals) {
+    genericRemoveValues(*this, vals);
+  }
+
+  void intersectWith(const DomainBitset& keep) {
+    genericIntersectWith(*this, keep);
+  }
+
+  template <typename F>
+  void forEachValue(F f) const {
+    genericForEachValue(*this, f);
+  }
+
+  DomainBitset domainAsBitset() const {
+    return genericDomainAsBitset(*this);
+  }
+
   void addDynamicTrigger(Trig_ConRef t, TrigType, DomainInt = NoDomainValue,
                          TrigOp op = TO_Default) {
     attachTriggerToNullList(t, op);
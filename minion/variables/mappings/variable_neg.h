@@ -111,6 +111,29 @@ struct VarNeg {
     data.removeFromDomain(-b);
   }
 
+  void removeValues(const vector<DomainInt>& vals) {
+    vector<DomainInt> negated;
+    negated.reserve(vals.size());
+    for(DomainInt v : vals)
+      negated.push_back(-v);
+    data.removeValues(negated);
+  }
+
+  // Negating reverses the order of values, so these are done a value at a
+  // time.
+  void intersectWith(const DomainBitset& keep) {
+    genericIntersectWith(*this, keep);
+  }
+
+  template <typename F>
+  void forEachValue(F f) const {
+    genericForEachValue(*this, f);
+  }
+
+  DomainBitset domainAsBitset() const {
+    return genericDomainAsBitset(*this);
+  }
+
   /// There isn't a minus sign here as domain changes from both the top and
   /// bottom of the domain are positive numbers.
   DomainInt getDomainChange(DomainDelta d) {
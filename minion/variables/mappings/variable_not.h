@@ -132,6 +132,23 @@ struct VarNot {
     data.removeFromDomain(swap(b));
   }
 
+  void removeValues(const vector<DomainInt>& vals) {
+    genericRemoveValues(*this, vals);
+  }
+
+  void intersectWith(const DomainBitset& keep) {
+    genericIntersectWith(*this, keep);
+  }
+
+  template <typename F>
+  void forEachValue(F f) const {
+    genericForEachValue(*this, f);
+  }
+
+  DomainBitset domainAsBitset() const {
+    return genericDomainAsBitset(*this);
+  }
+
   friend std::ostream& operator<<(std::ostream& o, const VarNot& n) {
     return o << "Not " << n.data;
   }
@@ -101,6 +101,31 @@ struct ShiftVar {
     data.removeFromDomain(b - shift);
   }
 
+  void removeValues(const vector<DomainInt>& vals) {
+    vector<DomainInt> shifted;
+    shifted.reserve(vals.size());
+    for(DomainInt v : vals)
+      shifted.push_back(v - shift);
+    data.removeValues(shifted);
+  }
+
+  void intersectWith(const DomainBitset& keep) {
+    DomainBitset shifted(keep);
+    shifted.base = shifted.base - shift;
+    data.intersectWith(shifted);
+  }
+
+  template <typename F>
+  void forEachValue(F f) const {
+    data.forEachValue([&](DomainInt v) { f(v + shift); });
+  }
+
+  DomainBitset domainAsBitset() const {
+    DomainBitset b = data.domainAsBitset();
+    b.base = b.base + shift;
+    return b;
+  }
+
   void addDynamicTrigger(Trig_ConRef t, TrigType type, DomainInt pos = NoDomainValue,
                          TrigOp op = TO_Default) {
     switch(type) {
@@ -338,6 +338,23 @@ struct MultiplyVar {
     FAIL_EXIT();
   }
 
+  void removeValues(const vector<DomainInt>& vals) {
+    genericRemoveValues(*this, vals);
+  }
+
+  void intersectWith(const DomainBitset& keep) {
+    genericIntersectWith(*this, keep);
+  }
+
+  template <typename F>
+  void forEachValue(F f) const {
+    genericForEachValue(*this, f);
+  }
+
+  DomainBitset domainAsBitset() const {
+    return genericDomainAsBitset(*this);
+  }
+
   void addDynamicTrigger(Trig_ConRef t, TrigType type, DomainInt pos = NoDomainValue,
                          TrigOp op = TO_Default) {
     switch(type) {
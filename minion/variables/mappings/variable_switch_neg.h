@@ -122,6 +122,23 @@ struct SwitchNeg {
     data.removeFromDomain(b * multiplier);
   }
 
+  void removeValues(const vector<DomainInt>& vals) {
+    genericRemoveValues(*this, vals);
+  }
+
+  void intersectWith(const DomainBitset& keep) {
+    genericIntersectWith(*this, keep);
+  }
+
+  template <typename F>
+  void forEachValue(F f) const {
+    genericForEachValue(*this, f);
+  }
+
+  DomainBitset domainAsBitset() const {
+    return genericDomainAsBitset(*this);
+  }
+
   /// There isn't a minus sign here as domain changes from both the top and
   /// bottom of the domain are positive numbers.
   DomainInt getDomainChange(DomainDelta d) {
@@ -80,3 +80,5 @@ public:
 #include "mappings/variable_shift.h"
 #include "mappings/variable_stretch.h"
 #include "mappings/variable_switch_neg.h"
+
+#include "TaggedVarRef.h"